@@ -1,6 +1,7 @@
 #include "IBlu.h"
 #include "Interfaces/IPluginManager.h"
 #include "BluManager.h"
+#include "Misc/ConfigCacheIni.h"
 
 class FBlu : public IBlu
 {
@@ -35,6 +36,11 @@ class FBlu : public IBlu
 		// Set the cache path
 		CefString(&BluManager::Settings.cache_path).FromString(GameDirCef);
 
+		// Render switches are fixed once CEF starts, so pick them now
+		BluManager::SelectRenderProfile();
+
+		GConfig->GetBool(TEXT("BLUI"), TEXT("bStructuredRendererMessages"), BluManager::bStructuredRendererMessages, GGameIni);
+
 		// Make a new manager instance
 		CefRefPtr<BluManager> BluApp = new BluManager();
 
@@ -1,5 +1,80 @@
 #include "BluBlueprintFunctionLibrary.h"
 #include "BluJsonObj.h"
+#include "BluRenderBenchmark.h"
+#include "BluJsonAsync.h"
+#include "BluJsonPatch.h"
+#include "BluJsonWriter.h"
+#include "LatentActions.h"
+#include "Engine/Engine.h"
+#include "Engine/World.h"
+
+namespace
+{
+	// Waits for an async JSON job, the job fills in the shared state on the game thread
+	template<typename TState>
+	class TBluJsonLatentAction : public FPendingLatentAction
+	{
+	public:
+
+		typedef TFunction<void(const TState&)> FFinish;
+
+		// Outlives this action if it's cancelled before the job is done
+		TSharedRef<TState> State;
+
+		TBluJsonLatentAction(const FLatentActionInfo& LatentInfo, FFinish InFinish)
+			: State(MakeShared<TState>())
+			, ExecutionFunction(LatentInfo.ExecutionFunction)
+			, OutputLink(LatentInfo.Linkage)
+			, CallbackTarget(LatentInfo.CallbackTarget)
+			, Finish(MoveTemp(InFinish))
+		{
+		}
+
+		virtual void UpdateOperation(FLatentResponse& Response) override
+		{
+			if (State->bDone)
+			{
+				Finish(*State);
+			}
+			Response.FinishAndTriggerIf(State->bDone, ExecutionFunction, OutputLink, CallbackTarget);
+		}
+
+	private:
+
+		FName ExecutionFunction;
+		int32 OutputLink;
+		FWeakObjectPtr CallbackTarget;
+		FFinish Finish;
+	};
+
+	struct FParseState
+	{
+		bool bDone = false;
+		TSharedPtr<FJsonObject> Object;
+	};
+
+	struct FSerializeState
+	{
+		bool bDone = false;
+		FString JsonString;
+	};
+
+	FLatentActionManager* GetLatentManager(UObject* WorldContextObject, const FLatentActionInfo& LatentInfo)
+	{
+		UWorld* World = GEngine->GetWorldFromContextObject(WorldContextObject, EGetWorldErrorMode::LogAndReturnNull);
+		if (!World)
+		{
+			return nullptr;
+		}
+
+		FLatentActionManager& LatentManager = World->GetLatentActionManager();
+		if (LatentManager.FindExistingAction<FPendingLatentAction>(LatentInfo.CallbackTarget, LatentInfo.UUID))
+		{
+			return nullptr;
+		}
+		return &LatentManager;
+	}
+}
 
 
 UBluBlueprintFunctionLibrary::UBluBlueprintFunctionLibrary(const class FObjectInitializer& PCIP)
@@ -30,7 +105,7 @@ UBluJsonObj* UBluBlueprintFunctionLibrary::NewBluJSONObj(UObject* WorldContextOb
 
 void UBluBlueprintFunctionLibrary::RunBluEventLoop()
 {
-	BluManager::DoBluMessageLoop();
+	UBluEye::RunMessageLoop(FApp::GetDeltaTime());
 }
 
 UBluJsonObj* UBluBlueprintFunctionLibrary::ParseJSON(const FString& JSONString)
@@ -43,18 +118,85 @@ UBluJsonObj* UBluBlueprintFunctionLibrary::ParseJSON(const FString& JSONString)
 
 }
 
+UBluJsonObj* UBluBlueprintFunctionLibrary::ParseJSONLazy(const FString& JSONString)
+{
+	UBluJsonObj* JsonObj = NewObject<UBluJsonObj>(GetTransientPackage(), UBluJsonObj::StaticClass());
+	JsonObj->InitLazy(JSONString);
+
+	return JsonObj;
+}
+
 FString UBluBlueprintFunctionLibrary::JSONToString(UBluJsonObj *ObjectToParse)
 {
+	TSharedPtr<FJsonObject> Object = ObjectToParse ? ObjectToParse->GetJsonObj() : nullptr;
+	if (!Object.IsValid())
+	{
+		return FString();
+	}
+
+	// Condensed, it's usually headed for a page rather than a person
+	return FBluJson::ToString(*Object);
+}
 
-	// Create the JSON reader
-	FString ReturnString;
-	TSharedRef<TJsonWriter<TCHAR>> writer = TJsonWriterFactory<TCHAR>::Create(&ReturnString);
+void UBluBlueprintFunctionLibrary::ParseJSONAsync(UObject* WorldContextObject, const FString& JSONString, UBluJsonObj*& Result, bool& bSuccess, FLatentActionInfo LatentInfo)
+{
+	FLatentActionManager* LatentManager = GetLatentManager(WorldContextObject, LatentInfo);
+	if (!LatentManager)
+	{
+		return;
+	}
+
+	// The UObject is only made once the node fires, so GC can't take it while it waits
+	auto* Action = new TBluJsonLatentAction<FParseState>(LatentInfo, [&Result, &bSuccess](const FParseState& State)
+	{
+		bSuccess = State.Object.IsValid();
+		Result = NewObject<UBluJsonObj>(GetTransientPackage(), UBluJsonObj::StaticClass());
+		Result->SetJsonObj(bSuccess ? State.Object : MakeShared<FJsonObject>());
+	});
+	LatentManager->AddNewAction(LatentInfo.CallbackTarget, LatentInfo.UUID, Action);
+
+	TSharedRef<FParseState> State = Action->State;
+	FBluJsonAsync::Parse(JSONString, [State](TSharedPtr<FJsonObject> Object)
+	{
+		State->Object = MoveTemp(Object);
+		State->bDone = true;
+	});
+}
 
-	// Convert the JSON object to an FString
-	FJsonSerializer::Serialize(ObjectToParse->GetJsonObj().ToSharedRef(), writer);
+void UBluBlueprintFunctionLibrary::JSONToStringAsync(UObject* WorldContextObject, UBluJsonObj* ObjectToParse, FString& Result, FLatentActionInfo LatentInfo)
+{
+	FLatentActionManager* LatentManager = GetLatentManager(WorldContextObject, LatentInfo);
+	if (!LatentManager)
+	{
+		return;
+	}
+
+	auto* Action = new TBluJsonLatentAction<FSerializeState>(LatentInfo, [&Result](const FSerializeState& State)
+	{
+		Result = State.JsonString;
+	});
+	LatentManager->AddNewAction(LatentInfo.CallbackTarget, LatentInfo.UUID, Action);
+
+	// Lazy objects are materialized and snapshotted here, on the game thread, so Blueprint can keep editing the original
+	const TSharedPtr<FJsonObject> JsonObj = ObjectToParse ? ObjectToParse->GetJsonObj() : nullptr;
+	TSharedPtr<FJsonObject> Snapshot = JsonObj.IsValid() ? TSharedPtr<FJsonObject>(FBluJsonPatch::CloneObject(*JsonObj)) : nullptr;
+
+	TSharedRef<FSerializeState> State = Action->State;
+	FBluJsonAsync::Serialize(Snapshot, [State](FString&& JsonString)
+	{
+		State->JsonString = MoveTemp(JsonString);
+		State->bDone = true;
+	});
+}
 
-	return ReturnString;
+FString UBluBlueprintFunctionLibrary::GetRenderProfile()
+{
+	return BluManager::RenderProfile.Name;
+}
 
+TMap<FString, float> UBluBlueprintFunctionLibrary::GetRenderBenchmarkResults()
+{
+	return FBluRenderBenchmark::GetResults();
 }
 
 FCharacterEvent UBluBlueprintFunctionLibrary::ToKeyEvent(FKey Key)
@@ -1,8 +1,156 @@
 
 #include "BluEye.h"
 #include "RenderHandler.h"
+#include "BluTeardownManager.h"
+#include "BluRenderBenchmark.h"
+#include "BluScripts.h"
+#include "BluJsonAsync.h"
+#include "BluJsonPatch.h"
+#include "BluJsonWriter.h"
+#include "BluMsgPack.h"
+#include "Json.h"
+#include "Misc/Base64.h"
+#include "Algo/StableSort.h"
+#include "LatentActions.h"
+#include "Engine/Engine.h"
+#include "Engine/World.h"
 
 FTickEventLoopData UBluEye::EventLoopData = FTickEventLoopData();
+TMap<FString, FBluSharedBrowser> UBluEye::SharedBrowsers;
+int32 UBluEye::NextRequestId = 0;
+
+namespace
+{
+	FString ToCondensedJson(const TSharedPtr<FJsonValue>& Value)
+	{
+		return FBluJson::ToString(Value);
+	}
+
+	// How values from the page are handed to Blueprints: strings as they are, null as empty and anything else as JSON
+	FString ToBlueprintString(const TSharedPtr<FJsonValue>& Value)
+	{
+		if (!Value.IsValid() || Value->Type == EJson::Null)
+		{
+			return FString();
+		}
+
+		if (Value->Type == EJson::String)
+		{
+			return Value->AsString();
+		}
+
+		return ToCondensedJson(Value);
+	}
+
+	// Smaller payloads parse faster than the trip to a worker and back
+	const int32 AsyncParseMinLength = 512;
+
+	// Is this event's data JSON worth parsing off the game thread?
+	bool ShouldParseAsync(const FBluEventPayload& Payload)
+	{
+		if (Payload.Type != EBluEventValueType::String || Payload.StringValue.Len() < AsyncParseMinLength)
+		{
+			return false;
+		}
+
+		const TCHAR* Start = *Payload.StringValue;
+		while (FChar::IsWhitespace(*Start))
+		{
+			Start++;
+		}
+		return *Start == TEXT('{') || *Start == TEXT('[');
+	}
+
+	// Parse a JSON message the page sent as an event's string data
+	TSharedPtr<FJsonObject> ReadMessageObject(const FBluEventPayload& Payload)
+	{
+		TSharedPtr<FJsonObject> Message;
+		if (Payload.Type == EBluEventValueType::Dictionary && Payload.StructuredValue.IsValid())
+		{
+			Message = Payload.StructuredValue->AsObject();
+		}
+		else
+		{
+			TSharedRef<TJsonReader<TCHAR>> Reader = TJsonReaderFactory<TCHAR>::Create(Payload.StringValue);
+			FJsonSerializer::Deserialize(Reader, Message);
+		}
+		return Message;
+	}
+
+	// Parse the {id, ok, value} message our evaluate wrapper sends back
+	bool ParseEvaluateMessage(const FBluEventPayload& Payload, int32& OutRequestId, FBluEvaluateResult& OutResult)
+	{
+		TSharedPtr<FJsonObject> Message = ReadMessageObject(Payload);
+		if (!Message.IsValid())
+		{
+			return false;
+		}
+
+		bool bOk = false;
+		if (!Message->TryGetNumberField(TEXT("id"), OutRequestId) || !Message->TryGetBoolField(TEXT("ok"), bOk))
+		{
+			return false;
+		}
+
+		// Undefined doesn't survive JSON.stringify, so value can be missing
+		TSharedPtr<FJsonValue> Value = Message->TryGetField(TEXT("value"));
+
+		if (bOk)
+		{
+			OutResult.Status = EBluEvaluateStatus::Success;
+			OutResult.Value = Value;
+		}
+		else
+		{
+			OutResult.Status = EBluEvaluateStatus::Exception;
+			OutResult.Error = Value.IsValid() ? Value->AsString() : FString();
+		}
+		return true;
+	}
+
+	class FBluEvaluateLatentAction : public FPendingLatentAction
+	{
+	public:
+
+		struct FState
+		{
+			bool bDone = false;
+			EBluEvaluateStatus Status = EBluEvaluateStatus::Cancelled;
+			FString Result;
+		};
+
+		// Outlives both the eye and this action, whichever goes first
+		TSharedRef<FState> State;
+
+		FBluEvaluateLatentAction(const FLatentActionInfo& LatentInfo, EBluEvaluateStatus& InStatus, FString& InResult)
+			: State(MakeShared<FState>())
+			, ExecutionFunction(LatentInfo.ExecutionFunction)
+			, OutputLink(LatentInfo.Linkage)
+			, CallbackTarget(LatentInfo.CallbackTarget)
+			, Status(InStatus)
+			, Result(InResult)
+		{
+		}
+
+		virtual void UpdateOperation(FLatentResponse& Response) override
+		{
+			if (State->bDone)
+			{
+				Status = State->Status;
+				Result = State->Result;
+			}
+			Response.FinishAndTriggerIf(State->bDone, ExecutionFunction, OutputLink, CallbackTarget);
+		}
+
+	private:
+
+		FName ExecutionFunction;
+		int32 OutputLink;
+		FWeakObjectPtr CallbackTarget;
+		EBluEvaluateStatus& Status;
+		FString& Result;
+	};
+}
 
 FBluEyeSettings::FBluEyeSettings()
 {
@@ -16,6 +164,34 @@ FBluEyeSettings::FBluEyeSettings()
 	bAudioMuted = false;
 	bAutoPlayEnabled = true;
 	bDebugLogTick = false;
+	bShareBrowser = false;
+	bSharedInputEnabled = false;
+	bEnableCrashRecovery = false;
+	bBatchScriptEvents = false;
+	bBatchJavaScript = false;
+	bParseScriptEventsAsync = false;
+}
+
+FString FBluEventPayload::ToString() const
+{
+	switch (Type)
+	{
+	case EBluEventValueType::Bool:
+		return BoolValue ? TEXT("true") : TEXT("false");
+	case EBluEventValueType::Int:
+		return FString::FromInt(IntValue);
+	case EBluEventValueType::Double:
+		return FString::SanitizeFloat(DoubleValue);
+	case EBluEventValueType::String:
+		return StringValue;
+	case EBluEventValueType::List:
+	case EBluEventValueType::Dictionary:
+		return FBluJson::ToString(StructuredValue);
+	case EBluEventValueType::Binary:
+		return FBase64::Encode(BinaryValue);
+	default:
+		return FString();
+	}
 }
 
 UBluEye::UBluEye(const class FObjectInitializer& PCIP)
@@ -23,6 +199,22 @@ UBluEye::UBluEye(const class FObjectInitializer& PCIP)
 {
 	Texture = nullptr;
 	bValidTexture = false;
+	Renderer = nullptr;
+	PreloadRenderer = nullptr;
+	bPreloadReady = false;
+	StandbyRenderer = nullptr;
+	RecoveryStartTime = 0.0;
+	LastRecoveryTime = 0.f;
+	ScriptEventsDispatched = 0;
+	ScriptEventsFiltered = 0;
+	bPendingMouseMove = false;
+	bPendingMouseWheel = false;
+	PendingWheelDelta = 0.f;
+	bHasFocus = false;
+	MouseMovesReceived = 0;
+	MouseMovesSent = 0;
+	MouseWheelsReceived = 0;
+	MouseWheelsSent = 0;
 }
 
 void UBluEye::Init()
@@ -48,6 +240,14 @@ void UBluEye::Init()
 		return;
 	}
 
+	// Reuse an existing browser if another eye already shows this page
+	if (Settings.bShareBrowser && AttachToSharedBrowser())
+	{
+		UE_LOG(LogBlu, Log, TEXT("Component Initialized with shared browser: %s"), *DefaultURL);
+		SpawnTickEventLoopIfNeeded();
+		return;
+	}
+
 	//BrowserSettings.universal_access_from_file_urls = STATE_ENABLED;
 	//BrowserSettings.file_access_from_file_urls = STATE_ENABLED;
 
@@ -65,7 +265,7 @@ void UBluEye::Init()
 	{
 		if (BluManager::CPURenderSettings)
 		{
-			UE_LOG(LogBlu, Error, TEXT("You have enabled WebGL for this browser, but CPU Saver is enabled in BluManager.cpp - WebGL will not work!"));
+			UE_LOG(LogBlu, Error, TEXT("You have enabled WebGL for this browser, but render profile '%s' disables the GPU - WebGL will not work!"), *BluManager::RenderProfile.Name);
 		}
 		BrowserSettings.webgl = STATE_ENABLED;
 	}
@@ -73,23 +273,7 @@ void UBluEye::Init()
 	//NB: this setting will change it globally for all new instances
 	BluManager::AutoPlay = Settings.bAutoPlayEnabled;
 
-	Renderer = new RenderHandler(Settings.ViewSize.X, Settings.ViewSize.Y, this);
-	ClientHandler = new BrowserClient(Renderer);
-	Browser = CefBrowserHost::CreateBrowserSync(
-		Info,
-		ClientHandler.get(),
-		"about:blank",
-		BrowserSettings,
-		nullptr,
-		nullptr);
-
-
-	Browser->GetHost()->SetWindowlessFrameRate(Settings.FrameRate);
-	Browser->GetHost()->SetAudioMuted(Settings.bAudioMuted);
-
-	// Setup JS event emitter
-	ClientHandler->SetEventEmitter(&ScriptEventEmitter);
-	ClientHandler->SetLogEmitter(&LogEventEmitter);
+	Browser = CreateBrowserInstance(TEXT("about:blank"), Renderer, ClientHandler);
 
 	UE_LOG(LogBlu, Log, TEXT("Component Initialized"));
 	UE_LOG(LogBlu, Log, TEXT("Loading URL: %s"), *DefaultURL);
@@ -98,8 +282,17 @@ void UBluEye::Init()
 	LoadURL(DefaultURL);
 	ResetTexture();
 
+	// Keep a warm browser around to take over if the renderer crashes
+	if (Settings.bEnableCrashRecovery)
+	{
+		SpawnStandbyBrowser();
+	}
+
 	//Instead of manually ticking, we now tick whenever one blu eye is created
 	SpawnTickEventLoopIfNeeded();
+
+	// Measure this render profile if the project asked for it
+	FBluRenderBenchmark::StartIfNeeded();
 }
 
 void UBluEye::ResetTexture()
@@ -129,14 +322,8 @@ void UBluEye::DestroyTexture()
 	// Here we destroy the texture and its resource
 	if (Texture)
 	{
+		// The texture releases its resource behind a render fence once GC gets to it, no need to flush here
 		Texture->RemoveFromRoot();
-
-		if (Texture->GetResource())
-		{
-			BeginReleaseResource(Texture->GetResource());
-			FlushRenderingCommands();
-		}
-
 		Texture->MarkAsGarbage();
 		Texture = nullptr;
 		bValidTexture = false;
@@ -194,10 +381,37 @@ void UBluEye::TextureUpdate(const void *buffer, FUpdateTextureRegion2D *updateRe
 
 void UBluEye::ExecuteJS(const FString& Code)
 {
+	if (Settings.bBatchJavaScript)
+	{
+		// One script per frame, so it's parsed once. The try blocks only catch errors thrown while running,
+		// a syntax error in any call stops the whole batch from compiling
+		PendingJS += TEXT("try{\n");
+		PendingJS += Code;
+		PendingJS += TEXT("\n}catch(e){console.error(e);}\n");
+		return;
+	}
+
+	// Anything queued before batching was turned off goes first
+	FlushJS();
+
 	CefString CodeStr = *Code;
 	Browser->GetMainFrame()->ExecuteJavaScript(CodeStr, "", 0);
 }
 
+void UBluEye::FlushJS()
+{
+	if (PendingJS.IsEmpty() || !Browser)
+	{
+		return;
+	}
+
+	CefString CodeStr = *PendingJS;
+	Browser->GetMainFrame()->ExecuteJavaScript(CodeStr, "", 0);
+
+	// Keep the allocation around for next frame
+	PendingJS.Reset();
+}
+
 void UBluEye::ExecuteJSMethodWithParams(const FString& methodName, const TArray<FString> params)
 {
 
@@ -219,146 +433,1321 @@ void UBluEye::ExecuteJSMethodWithParams(const FString& methodName, const TArray<
 	ExecuteJS(methodName + ParamString);
 }
 
-void UBluEye::LoadURL(const FString& newURL)
+void UBluEye::CallJSFunction(const FString& FunctionName, const TArray<TSharedPtr<FJsonValue>>& Args)
 {
-	FString FinalUrl = newURL;
-
-	//Detect chrome-devtools, and re-target them to regular devtools
-	if (newURL.Contains(TEXT("chrome-devtools://devtools")))
+	if (!Browser)
 	{
-		//devtools://devtools/inspector.html?v8only=true&ws=localhost:9229
-		//browser->GetHost()->ShowDevTools(info, g_handler, browserSettings, CefPoint());
-		FinalUrl = FinalUrl.Replace(TEXT("chrome-devtools://devtools/bundled/inspector.html"), TEXT("devtools://devtools/inspector.html"));
+		return;
 	}
 
-	// Check if we want to load a local file
-	if (newURL.Contains(TEXT("blui://"), ESearchCase::IgnoreCase, ESearchDir::FromStart))
+	if (BluManager::bStructuredRendererMessages)
 	{
+		// Keep order with script that's already queued
+		FlushJS();
 
-		// Get the current working directory
-		FString GameDir = FPaths::ConvertRelativePathToFull(FPaths::ProjectDir());
+		CefRefPtr<CefListValue> ArgList = CefListValue::Create();
+		ArgList->SetSize(Args.Num());
+		for (int32 Index = 0; Index < Args.Num(); Index++)
+		{
+			ArgList->SetValue(Index, JsonToCefValue(Args[Index]));
+		}
 
-		// We're loading a local file, so replace the proto with our game directory path
-		FString LocalFile = newURL.Replace(TEXT("blui://"), *GameDir, ESearchCase::IgnoreCase);
+		CefRefPtr<CefProcessMessage> Message = CefProcessMessage::Create("blu_call");
+		Message->GetArgumentList()->SetString(0, *FunctionName);
+		Message->GetArgumentList()->SetList(1, ArgList);
+		Browser->GetMainFrame()->SendProcessMessage(PID_RENDERER, Message);
+		return;
+	}
 
-		// Now we use the file proto
-		LocalFile = FString(TEXT("file:///")) + LocalFile;
+	// Older render processes only take script, JSON is a valid JS literal so the arguments still need no escaping
+	ExecuteJS(FString::Printf(TEXT("%s(...%s);"), *FunctionName, *FBluJson::ToString(Args)));
+}
 
-		UE_LOG(LogBlu, Log, TEXT("Load Local File: %s"), *LocalFile)
+void UBluEye::CallJSFunctionWithStrings(const FString& FunctionName, const TArray<FString>& Args)
+{
+	if (!Browser)
+	{
+		return;
+	}
+
+	if (BluManager::bStructuredRendererMessages)
+	{
+		FlushJS();
 
-		// Load it up 
-		Browser->GetMainFrame()->LoadURL(*LocalFile);
+		CefRefPtr<CefListValue> ArgList = CefListValue::Create();
+		ArgList->SetSize(Args.Num());
+		for (int32 Index = 0; Index < Args.Num(); Index++)
+		{
+			ArgList->SetString(Index, *Args[Index]);
+		}
 
+		CefRefPtr<CefProcessMessage> Message = CefProcessMessage::Create("blu_call");
+		Message->GetArgumentList()->SetString(0, *FunctionName);
+		Message->GetArgumentList()->SetList(1, ArgList);
+		Browser->GetMainFrame()->SendProcessMessage(PID_RENDERER, Message);
 		return;
+	}
 
+	// Straight from the strings, no FJsonValue per argument
+	TArray<TCHAR>& Buffer = FBluJsonWriter::GetThreadBuffer();
+	FBluJsonWriter(Buffer).WriteArray(Args);
+	const FString ArgsJson(Buffer.Num(), Buffer.GetData());
+	FBluJsonWriter::ReleaseThreadBuffer(Buffer);
+
+	ExecuteJS(FString::Printf(TEXT("%s(...%s);"), *FunctionName, *ArgsJson));
+}
+
+void UBluEye::CallJSFunctionWithJson(const FString& FunctionName, UBluJsonObj* Arg)
+{
+	if (!Arg)
+	{
+		return;
 	}
 
-	// Load as usual
-	Browser->GetMainFrame()->LoadURL(*FinalUrl);
+	TArray<TSharedPtr<FJsonValue>> JsonArgs;
+	JsonArgs.Add(MakeShared<FJsonValueObject>(Arg->GetJsonObj()));
 
+	CallJSFunction(FunctionName, JsonArgs);
 }
 
-FString UBluEye::GetCurrentURL()
+int32 UBluEye::EvaluateJS(const FString& Code, FBluEvaluateCallback Callback, float TimeoutSeconds)
 {
-	return FString(Browser->GetMainFrame()->GetURL().c_str());
+	const int32 RequestId = ++NextRequestId;
+
+	if (!Browser)
+	{
+		FBluEvaluateResult Result;
+		Result.Status = EBluEvaluateStatus::Cancelled;
+		Callback(Result);
+		return RequestId;
+	}
+
+	FBluPendingEvaluation& Pending = PendingEvaluations.Add(RequestId);
+	Pending.Callback = MoveTemp(Callback);
+	Pending.Deadline = TimeoutSeconds > 0.f ? FPlatformTime::Seconds() + TimeoutSeconds : 0.0;
+
+	ExecuteJS(BluScripts::MakeEvaluateScript(RequestId, Code));
+
+	return RequestId;
 }
 
-void UBluEye::SetZoom(const float Scale /*= 1*/)
+void UBluEye::CancelEvaluateJS(int32 RequestId)
 {
-	Browser->GetHost()->SetZoomLevel(Scale);
+	FBluEvaluateResult Result;
+	Result.Status = EBluEvaluateStatus::Cancelled;
+	CompleteEvaluation(RequestId, Result);
 }
 
-float UBluEye::GetZoom()
+void UBluEye::EvaluateJSLatent(UObject* WorldContextObject, const FString& Code, float TimeoutSeconds, EBluEvaluateStatus& Status, FString& Result, FLatentActionInfo LatentInfo)
 {
-	return Browser->GetHost()->GetZoomLevel();
+	UWorld* World = GEngine->GetWorldFromContextObject(WorldContextObject, EGetWorldErrorMode::LogAndReturnNull);
+	if (!World)
+	{
+		return;
+	}
+
+	FLatentActionManager& LatentManager = World->GetLatentActionManager();
+	if (LatentManager.FindExistingAction<FBluEvaluateLatentAction>(LatentInfo.CallbackTarget, LatentInfo.UUID))
+	{
+		return;
+	}
+
+	FBluEvaluateLatentAction* Action = new FBluEvaluateLatentAction(LatentInfo, Status, Result);
+	LatentManager.AddNewAction(LatentInfo.CallbackTarget, LatentInfo.UUID, Action);
+
+	TSharedRef<FBluEvaluateLatentAction::FState> State = Action->State;
+	EvaluateJS(Code, [State](const FBluEvaluateResult& EvalResult)
+	{
+		State->bDone = true;
+		State->Status = EvalResult.Status;
+
+		State->Result = EvalResult.Status == EBluEvaluateStatus::Exception ? EvalResult.Error : ToBlueprintString(EvalResult.Value);
+	}, TimeoutSeconds);
 }
 
-void UBluEye::DownloadFile(const FString& FileUrl)
+bool UBluEye::CompleteEvaluation(int32 RequestId, const FBluEvaluateResult& Result)
 {
-	Browser->GetHost()->StartDownload(*FileUrl);
-	//Todo: ensure downloading works in some way, shape or form?
+	FBluPendingEvaluation Pending;
+	if (!PendingEvaluations.RemoveAndCopyValue(RequestId, Pending))
+	{
+		return false;
+	}
+
+	// Removed first, the callback is free to evaluate again
+	Pending.Callback(Result);
+	return true;
 }
 
-bool UBluEye::IsBrowserLoading()
+void UBluEye::ExpireEvaluations()
 {
-	return Browser->IsLoading();
+	if (PendingEvaluations.Num() == 0)
+	{
+		return;
+	}
+
+	const double Now = FPlatformTime::Seconds();
+
+	TArray<int32, TInlineAllocator<8>> Expired;
+	for (const TPair<int32, FBluPendingEvaluation>& Pair : PendingEvaluations)
+	{
+		if (Pair.Value.Deadline > 0.0 && Now >= Pair.Value.Deadline)
+		{
+			Expired.Add(Pair.Key);
+		}
+	}
+
+	FBluEvaluateResult Result;
+	Result.Status = EBluEvaluateStatus::TimedOut;
+	for (int32 RequestId : Expired)
+	{
+		CompleteEvaluation(RequestId, Result);
+	}
 }
 
-void UBluEye::ReloadBrowser(bool IgnoreCache)
+void UBluEye::CancelAllEvaluations()
 {
+	TArray<int32> RequestIds;
+	PendingEvaluations.GetKeys(RequestIds);
 
-	if (IgnoreCache)
+	FBluEvaluateResult Result;
+	Result.Status = EBluEvaluateStatus::Cancelled;
+	for (int32 RequestId : RequestIds)
 	{
-		return Browser->ReloadIgnoreCache();
+		CompleteEvaluation(RequestId, Result);
 	}
+}
 
-	Browser->Reload();
+void UBluEye::SetNativeQueryHandler(FName QueryName, FBluNativeQueryHandler Handler)
+{
+	NativeQueryHandlers.Add(QueryName, MoveTemp(Handler));
+}
 
+void UBluEye::SetQueryHandler(FName QueryName, const FBluQueryHandler& Handler)
+{
+	QueryHandlers.Add(QueryName, Handler);
 }
 
-void UBluEye::NavBack()
+void UBluEye::ClearQueryHandler(FName QueryName)
+{
+	NativeQueryHandlers.Remove(QueryName);
+	QueryHandlers.Remove(QueryName);
+}
+
+void UBluEye::RespondToQuery(int32 QueryId, bool bSuccess, const FString& Response)
 {
+	RespondToQueryWithValue(QueryId, bSuccess, MakeShared<FJsonValueString>(Response));
+}
 
-	if (Browser->CanGoBack())
+void UBluEye::RespondToQueryWithJson(int32 QueryId, UBluJsonObj* Response)
+{
+	if (!Response)
 	{
-		Browser->GoBack();
+		RespondToQueryWithValue(QueryId, true, MakeShared<FJsonValueNull>());
+		return;
 	}
 
+	RespondToQueryWithValue(QueryId, true, MakeShared<FJsonValueObject>(Response->GetJsonObj()));
 }
 
-void UBluEye::NavForward()
+void UBluEye::RespondToQueryWithValue(int32 QueryId, bool bSuccess, const TSharedPtr<FJsonValue>& Response)
 {
-
-	if (Browser->CanGoForward())
+	int32 PageQueryId = 0;
+	if (!PendingQueries.RemoveAndCopyValue(QueryId, PageQueryId))
 	{
-		Browser->GoForward();
+		// Cancelled, or already answered
+		UE_LOG(LogBlu, Verbose, TEXT("Query %d is no longer pending"), QueryId);
+		return;
 	}
 
+	SendQueryResponse(PageQueryId, bSuccess, Response);
 }
 
-UTexture2D* UBluEye::ResizeBrowser(const int32 NewWidth, const int32 NewHeight)
+bool UBluEye::IsQueryPending(int32 QueryId) const
 {
+	return PendingQueries.Contains(QueryId);
+}
 
-	if (NewWidth <= 0 || NewHeight <= 0)
+bool UBluEye::HasQueryHandler(FName QueryName) const
+{
+	return NativeQueryHandlers.Contains(QueryName) || QueryHandlers.Contains(QueryName);
+}
+
+void UBluEye::StartQuery(int32 PageQueryId, FName QueryName, const TSharedPtr<FJsonValue>& Payload)
+{
+	const int32 QueryId = ++NextRequestId;
+
+	// Added before calling the handler so it can respond right away
+	PendingQueries.Add(QueryId, PageQueryId);
+
+	if (const FBluNativeQueryHandler* NativeHandler = NativeQueryHandlers.Find(QueryName))
 	{
-		// We can't do this, just do nothing.
-		UE_LOG(LogBlu, Log, TEXT("Can't resize when one or both of the sizes are <= 0!"));
-		return Texture;
+		// Copy in case the handler replaces itself
+		const FBluNativeQueryHandler Handler = *NativeHandler;
+		Handler(QueryId, Payload);
+		return;
 	}
 
-	// Disable the web view while we resize
-	bEnabled = false;
+	if (const FBluQueryHandler* Handler = QueryHandlers.Find(QueryName))
+	{
+		const FBluQueryHandler HandlerCopy = *Handler;
+		HandlerCopy.ExecuteIfBound(QueryId, ToBlueprintString(Payload));
+	}
+}
 
-	// Set our new Width and Height
-	Settings.ViewSize.X = NewWidth;
-	Settings.ViewSize.Y = NewHeight;
-	
-	// Update our render handler
-	Renderer->Width = NewWidth;
-	Renderer->Height = NewHeight;
+void UBluEye::SendQueryResponse(int32 PageQueryId, bool bSuccess, const TSharedPtr<FJsonValue>& Response)
+{
+	ExecuteJS(FString::Printf(TEXT("blui.__resolveQuery(%d,%s,%s);"), PageQueryId, bSuccess ? TEXT("true") : TEXT("false"), *ToCondensedJson(Response)));
+}
 
-	bValidTexture = false;
+void UBluEye::CancelAllQueries()
+{
+	if (PendingQueries.Num() == 0)
+	{
+		return;
+	}
 
-	Texture = UTexture2D::CreateTransient(Settings.ViewSize.X, Settings.ViewSize.Y, PF_B8G8R8A8);
-	Texture->AddToRoot();
-	Texture->UpdateResource();
+	TArray<int32> QueryIds;
+	PendingQueries.GetKeys(QueryIds);
+	PendingQueries.Reset();
 
-	bValidTexture = true;
+	for (int32 QueryId : QueryIds)
+	{
+		NativeQueryCancelled.Broadcast(QueryId);
 
-	// Let the browser's host know we resized it
-	Browser->GetHost()->WasResized();
+		if (QueryCancelled.IsBound())
+		{
+			QueryCancelled.Broadcast(QueryId);
+		}
+	}
+}
 
-	// Now we can keep going
-	bEnabled = true;
+void UBluEye::CancelPageRequests()
+{
+	CancelAllEvaluations();
+	CancelAllQueries();
+}
 
-	UE_LOG(LogBlu, Log, TEXT("BluEye was resized!"))
+void UBluEye::SendBulkData(FName Channel, const void* Data, int32 NumBytes, const TCHAR* ArrayType)
+{
+	if (!Browser)
+	{
+		return;
+	}
 
-	return Texture;
+	if (BluManager::bStructuredRendererMessages)
+	{
+		// Keep the order with anything batched before us
+		FlushJS();
+
+		CefRefPtr<CefProcessMessage> Message = CefProcessMessage::Create("blu_bulk");
+		Message->GetArgumentList()->SetString(0, *Channel.ToString());
+		Message->GetArgumentList()->SetString(1, ArrayType);
+		Message->GetArgumentList()->SetBinary(2, CefBinaryValue::Create(Data, NumBytes));
+		Browser->GetMainFrame()->SendProcessMessage(PID_RENDERER, Message);
+		return;
+	}
+
+	// Base64 is the most compact thing script can carry, the page decodes it straight into the typed array
+	ExecuteJS(FString::Printf(TEXT("blui.__receiveBulk(%s,%s,'%s');"),
+		*BluScripts::QuoteString(Channel.ToString()),
+		*BluScripts::QuoteString(ArrayType),
+		*FBase64::Encode(static_cast<const uint8*>(Data), NumBytes)));
+}
+
+void UBluEye::SendBulkBytes(FName Channel, const TArray<uint8>& Data)
+{
+	SendBulkArray(Channel, Data);
+}
+
+void UBluEye::SendBulkFloats(FName Channel, const TArray<float>& Data)
+{
+	SendBulkArray(Channel, Data);
+}
+
+void UBluEye::SendBulkInts(FName Channel, const TArray<int32>& Data)
+{
+	SendBulkArray(Channel, Data);
+}
+
+void UBluEye::SendBulkJson(FName Channel, const FJsonObject& Json)
+{
+	TArray<ANSICHAR>& Buffer = FBluJsonUtf8Writer::GetThreadBuffer();
+	FBluJson::ToUtf8(Json, Buffer);
+	SendBulkData(Channel, Buffer.GetData(), Buffer.Num());
+	FBluJsonUtf8Writer::ReleaseThreadBuffer(Buffer);
+}
+
+void UBluEye::SendMessagePack(FName Channel, UBluJsonObj* Json)
+{
+	if (!Json)
+	{
+		return;
+	}
+
+	TArray<uint8> Data;
+	Json->ToMessagePack(Data);
+	SendBulkData(Channel, Data.GetData(), Data.Num());
+}
+
+void UBluEye::SendMessagePack(FName Channel, const FJsonObject& Json)
+{
+	TArray<uint8> Data;
+	FBluMsgPack::Encode(Json, Data);
+	SendBulkData(Channel, Data.GetData(), Data.Num());
+}
+
+void UBluEye::DispatchBulkData(FName Channel, const TArray<uint8>& Data)
+{
+	// Every eye sharing our browser gets the page's data
+	if (const FBluSharedBrowser* Shared = SharedBrowsers.Find(SharedKey))
+	{
+		for (UBluEye* Eye : Shared->Eyes)
+		{
+			Eye->NativeBulkDataReceived.Broadcast(Channel, Data);
+			if (Eye->BulkDataReceived.IsBound())
+			{
+				Eye->BulkDataReceived.Broadcast(Channel, Data);
+			}
+		}
+		return;
+	}
+
+	NativeBulkDataReceived.Broadcast(Channel, Data);
+	if (BulkDataReceived.IsBound())
+	{
+		BulkDataReceived.Broadcast(Channel, Data);
+	}
+}
+
+void UBluEye::BindModel(FName ModelName, UObject* Object)
+{
+	if (!Object)
+	{
+		UnbindModel(ModelName);
+		return;
+	}
+
+	ModelBindings.Add(ModelName, MakeUnique<FBluModelBinding>(Object));
+}
+
+void UBluEye::BindStructModel(FName ModelName, const UScriptStruct* Struct, const void* Data)
+{
+	if (!Struct || !Data)
+	{
+		UnbindModel(ModelName);
+		return;
+	}
+
+	ModelBindings.Add(ModelName, MakeUnique<FBluModelBinding>(Struct, Data));
+}
+
+void UBluEye::UnbindModel(FName ModelName)
+{
+	ModelBindings.Remove(ModelName);
+}
+
+void UBluEye::PushModelChanges()
+{
+	if (ModelBindings.Num() == 0 || !Browser)
+	{
+		return;
+	}
+
+	// Changes are written straight into one script, no FJsonObject is built for them
+	TArray<TCHAR>& Buffer = FBluJsonWriter::GetThreadBuffer();
+	FBluJsonWriter Writer(Buffer);
+	Writer.BeginObject();
+
+	bool bChanged = false;
+	for (auto It = ModelBindings.CreateIterator(); It; ++It)
+	{
+		FBluModelBinding& Binding = *It.Value();
+		if (!Binding.IsValid())
+		{
+			It.RemoveCurrent();
+			continue;
+		}
+
+		// Take the model back out if none of its fields changed
+		const int32 Rollback = Buffer.Num();
+		Writer.WriteKey(It.Key().ToString());
+		Writer.BeginObject();
+		if (Binding.CollectChanges(Writer))
+		{
+			Writer.EndObject();
+			bChanged = true;
+		}
+		else
+		{
+			Buffer.SetNum(Rollback);
+		}
+	}
+
+	Writer.EndObject();
+
+	if (!bChanged)
+	{
+		FBluJsonWriter::ReleaseThreadBuffer(Buffer);
+		return;
+	}
+
+	const FString Updates(Buffer.Num(), Buffer.GetData());
+	FBluJsonWriter::ReleaseThreadBuffer(Buffer);
+
+	// The page may not have our helpers yet, it gets everything again once it finishes loading
+	ExecuteJS(FString::Printf(TEXT("window.blui&&blui.__updateModels&&blui.__updateModels(%s);"), *Updates));
+}
+
+void UBluEye::MarkModelsDirty()
+{
+	for (TPair<FName, TUniquePtr<FBluModelBinding>>& Pair : ModelBindings)
+	{
+		Pair.Value->MarkAllDirty();
+	}
+
+	for (TPair<FName, FBluSyncedJsonState>& Pair : SyncedJsonStates)
+	{
+		Pair.Value.bResend = true;
+	}
+}
+
+void UBluEye::SyncJsonState(FName StateName, UBluJsonObj* State)
+{
+	TSharedPtr<FJsonObject> Object = State ? State->GetJsonObj() : nullptr;
+	if (!Object.IsValid())
+	{
+		ClearJsonState(StateName);
+		return;
+	}
+
+	SyncJsonState(StateName, *Object);
+}
+
+void UBluEye::SyncJsonState(FName StateName, const FJsonObject& State)
+{
+	FBluSyncedJsonState& Synced = SyncedJsonStates.FindOrAdd(StateName);
+	if (!Synced.Sent.IsValid() || Synced.bResend)
+	{
+		Synced.Sent = FBluJsonPatch::CloneObject(State);
+		Synced.bResend = true;
+		ResendJsonStates();
+		return;
+	}
+
+	TArray<TSharedPtr<FJsonValue>> Patch = FBluJsonPatch::Diff(*Synced.Sent, State);
+	if (Patch.Num() == 0)
+	{
+		return;
+	}
+
+	// Patching our copy only touches what changed, cheaper than copying State again
+	FBluJsonPatch::Apply(*Synced.Sent, Patch);
+
+	ExecuteJS(FString::Printf(TEXT("window.blui&&blui.__patchState&&blui.__patchState(%s,%s);"),
+		*BluScripts::QuoteString(StateName.ToString()), *FBluJsonPatch::ToString(Patch)));
+}
+
+void UBluEye::ClearJsonState(FName StateName)
+{
+	if (SyncedJsonStates.Remove(StateName) > 0)
+	{
+		ExecuteJS(FString::Printf(TEXT("window.blui&&blui.__clearState&&blui.__clearState(%s);"), *BluScripts::QuoteString(StateName.ToString())));
+	}
+}
+
+void UBluEye::ResendJsonStates()
+{
+	if (!Browser)
+	{
+		return;
+	}
+
+	for (TPair<FName, FBluSyncedJsonState>& Pair : SyncedJsonStates)
+	{
+		if (!Pair.Value.bResend)
+		{
+			continue;
+		}
+
+		// The page may not have our helpers yet, it gets everything again once it finishes loading
+		Pair.Value.bResend = false;
+		ExecuteJS(FString::Printf(TEXT("window.blui&&blui.__setState&&blui.__setState(%s,%s);"),
+			*BluScripts::QuoteString(Pair.Key.ToString()), *ToCondensedJson(MakeShared<FJsonValueObject>(Pair.Value.Sent))));
+	}
+}
+
+void UBluEye::LoadURL(const FString& newURL)
+{
+	FlushJS();
+
+	RekeySharedBrowser(newURL);
+
+	Browser->GetMainFrame()->LoadURL(*ResolveURL(newURL));
+}
+
+FString UBluEye::ResolveURL(const FString& newURL) const
+{
+	FString FinalUrl = newURL;
+
+	//Detect chrome-devtools, and re-target them to regular devtools
+	if (newURL.Contains(TEXT("chrome-devtools://devtools")))
+	{
+		//devtools://devtools/inspector.html?v8only=true&ws=localhost:9229
+		//browser->GetHost()->ShowDevTools(info, g_handler, browserSettings, CefPoint());
+		FinalUrl = FinalUrl.Replace(TEXT("chrome-devtools://devtools/bundled/inspector.html"), TEXT("devtools://devtools/inspector.html"));
+	}
+
+	// Check if we want to load a local file
+	if (newURL.Contains(TEXT("blui://"), ESearchCase::IgnoreCase, ESearchDir::FromStart))
+	{
+
+		// Get the current working directory
+		FString GameDir = FPaths::ConvertRelativePathToFull(FPaths::ProjectDir());
+
+		// We're loading a local file, so replace the proto with our game directory path
+		FString LocalFile = newURL.Replace(TEXT("blui://"), *GameDir, ESearchCase::IgnoreCase);
+
+		// Now we use the file proto
+		LocalFile = FString(TEXT("file:///")) + LocalFile;
+
+		UE_LOG(LogBlu, Log, TEXT("Load Local File: %s"), *LocalFile)
+
+		return LocalFile;
+
+	}
+
+	// Load as usual
+	return FinalUrl;
+
+}
+
+CefRefPtr<CefBrowser> UBluEye::CreateBrowserInstance(const FString& InitialURL, RenderHandler*& OutRenderer, CefRefPtr<BrowserClient>& OutClient)
+{
+	OutRenderer = new RenderHandler(Settings.ViewSize.X, Settings.ViewSize.Y, this);
+	OutClient = new BrowserClient(OutRenderer);
+
+	CefRefPtr<CefBrowser> NewBrowser = CefBrowserHost::CreateBrowserSync(
+		Info,
+		OutClient.get(),
+		*InitialURL,
+		BrowserSettings,
+		nullptr,
+		nullptr);
+
+	NewBrowser->GetHost()->SetWindowlessFrameRate(Settings.FrameRate);
+	NewBrowser->GetHost()->SetAudioMuted(Settings.bAudioMuted);
+
+	return NewBrowser;
+}
+
+void UBluEye::SwapActiveBrowser(CefRefPtr<CefBrowser> NewBrowser, CefRefPtr<BrowserClient> NewClient, RenderHandler* NewRenderer)
+{
+	CefRefPtr<CefBrowser> OldBrowser = Browser;
+	CefRefPtr<BrowserClient> OldClient = ClientHandler;
+
+	Browser = NewBrowser;
+	ClientHandler = NewClient;
+	Renderer = NewRenderer;
+
+	// We may have been resized since the new browser was created
+	if (Renderer->Width != int32(Settings.ViewSize.X) || Renderer->Height != int32(Settings.ViewSize.Y))
+	{
+		Renderer->Width = Settings.ViewSize.X;
+		Renderer->Height = Settings.ViewSize.Y;
+		Browser->GetHost()->WasResized();
+	}
+
+	Renderer->bPaintingEnabled = true;
+
+	// The texture keeps the old frame until the new browser repaints all of it
+	Browser->GetHost()->WasHidden(false);
+	Browser->GetHost()->SetAudioMuted(Settings.bAudioMuted);
+	Browser->GetHost()->Invalidate(PET_VIEW);
+
+	// Eyes sharing our browser need to follow along
+	if (FBluSharedBrowser* Shared = SharedBrowsers.Find(SharedKey))
+	{
+		for (UBluEye* Eye : Shared->Eyes)
+		{
+			Eye->Browser = Browser;
+			Eye->ClientHandler = ClientHandler;
+			Eye->Renderer = Renderer;
+			Eye->bHasFocus = false;
+			Eye->CancelPageRequests();
+		}
+	}
+	else
+	{
+		// Nothing in the old page is going to answer
+		bHasFocus = false;
+		CancelPageRequests();
+	}
+
+	FBluTeardownManager::QueueClose(OldBrowser, OldClient);
+}
+
+void UBluEye::PreloadURL(const FString& NewURL)
+{
+	if (!Browser)
+	{
+		UE_LOG(LogBlu, Warning, TEXT("Can't preload before the BluEye is initialized"));
+		return;
+	}
+
+	// Only one page can be waiting at a time
+	DiscardPreloaded();
+
+	PreloadedURL = NewURL;
+	bPreloadReady = false;
+
+	PreloadBrowser = CreateBrowserInstance(ResolveURL(NewURL), PreloadRenderer, PreloadClient);
+
+	// Lay out and run the page without uploading anything to our texture
+	PreloadRenderer->bPaintingEnabled = false;
+	PreloadBrowser->GetHost()->SetAudioMuted(true);
+	PreloadBrowser->GetHost()->WasHidden(true);
+
+	UE_LOG(LogBlu, Log, TEXT("Preloading URL: %s"), *NewURL);
+}
+
+bool UBluEye::IsPreloadReady() const
+{
+	return PreloadBrowser && bPreloadReady;
+}
+
+bool UBluEye::ActivatePreloaded()
+{
+	if (!IsPreloadReady())
+	{
+		return false;
+	}
+
+	RekeySharedBrowser(PreloadedURL);
+	SwapActiveBrowser(PreloadBrowser, PreloadClient, PreloadRenderer);
+
+	PreloadBrowser = nullptr;
+	PreloadClient = nullptr;
+	PreloadRenderer = nullptr;
+	bPreloadReady = false;
+
+	UE_LOG(LogBlu, Log, TEXT("Activated preloaded URL: %s"), *PreloadedURL);
+
+	return true;
+}
+
+void UBluEye::DiscardPreloaded()
+{
+	if (PreloadBrowser)
+	{
+		FBluTeardownManager::QueueClose(PreloadBrowser, PreloadClient);
+	}
+
+	PreloadBrowser = nullptr;
+	PreloadClient = nullptr;
+	PreloadRenderer = nullptr;
+	bPreloadReady = false;
+}
+
+void UBluEye::OnBrowserLoadStart(CefRefPtr<CefBrowser> LoadingBrowser)
+{
+	if (!Browser || !Browser->IsSame(LoadingBrowser))
+	{
+		return;
+	}
+
+	// Whatever the old page was waiting on, it won't be around to get it
+	if (FBluSharedBrowser* Shared = SharedBrowsers.Find(SharedKey))
+	{
+		for (UBluEye* Eye : Shared->Eyes)
+		{
+			Eye->CancelPageRequests();
+		}
+		return;
+	}
+
+	CancelPageRequests();
+}
+
+void UBluEye::OnBrowserLoadComplete(CefRefPtr<CefBrowser> LoadedBrowser)
+{
+	InjectPageScripts(LoadedBrowser);
+
+	if (PreloadBrowser && PreloadBrowser->IsSame(LoadedBrowser))
+	{
+		bPreloadReady = true;
+		PreloadComplete.Broadcast(PreloadedURL);
+		return;
+	}
+
+	if (!Browser || !Browser->IsSame(LoadedBrowser))
+	{
+		return;
+	}
+
+	// The standby's own about:blank isn't a page worth remembering or recovering to
+	const FString LoadedURL = FString(Browser->GetMainFrame()->GetURL().c_str());
+	if (LoadedURL.IsEmpty() || LoadedURL == TEXT("about:blank"))
+	{
+		return;
+	}
+
+	// Remember where we are in case the renderer goes down
+	LastLoadedURL = LoadedURL;
+
+	// The new page starts with empty models
+	if (FBluSharedBrowser* Shared = SharedBrowsers.Find(SharedKey))
+	{
+		for (UBluEye* Eye : Shared->Eyes)
+		{
+			Eye->MarkModelsDirty();
+		}
+	}
+	else
+	{
+		MarkModelsDirty();
+	}
+
+	if (RecoveryStartTime > 0.0)
+	{
+		FinishCrashRecovery();
+	}
+}
+
+void UBluEye::DispatchScriptEvent(const FString& EventName, const FBluEventPayload& Payload)
+{
+	// Anything after an event that's still being parsed has to wait its turn
+	const bool bParse = Settings.bParseScriptEventsAsync && ShouldParseAsync(Payload);
+	if (bParse || QueuedScriptEvents.Num() > 0)
+	{
+		FBluQueuedScriptEvent& Queued = QueuedScriptEvents.AddDefaulted_GetRef();
+		Queued.Name = EventName;
+		Queued.Payload = Payload;
+		if (bParse)
+		{
+			Queued.ParsedValue = FBluJsonAsync::ParseValue(Payload.StringValue);
+		}
+		return;
+	}
+
+	HandleScriptEvent(EventName, Payload);
+}
+
+void UBluEye::DeliverQueuedScriptEvents()
+{
+	int32 NumReady = 0;
+	while (NumReady < QueuedScriptEvents.Num())
+	{
+		FBluQueuedScriptEvent& Queued = QueuedScriptEvents[NumReady];
+		if (Queued.ParsedValue.IsValid())
+		{
+			if (!Queued.ParsedValue.IsReady())
+			{
+				break;
+			}
+
+			// Left as the string it came in as if it didn't parse
+			TSharedPtr<FJsonValue> Value = Queued.ParsedValue.Get();
+			if (Value.IsValid() && (Value->Type == EJson::Object || Value->Type == EJson::Array))
+			{
+				Queued.Payload.Type = Value->Type == EJson::Object ? EBluEventValueType::Dictionary : EBluEventValueType::List;
+				Queued.Payload.StructuredValue = Value;
+				Queued.Payload.StringValue.Empty();
+			}
+		}
+		NumReady++;
+	}
+
+	if (NumReady == 0)
+	{
+		return;
+	}
+
+	// Take them off first, a listener could send us more events
+	TArray<FBluQueuedScriptEvent> Ready;
+	Ready.Reserve(NumReady);
+	for (int32 i = 0; i < NumReady; i++)
+	{
+		Ready.Add(MoveTemp(QueuedScriptEvents[i]));
+	}
+	QueuedScriptEvents.RemoveAt(0, NumReady);
+
+	for (const FBluQueuedScriptEvent& Queued : Ready)
+	{
+		HandleScriptEvent(Queued.Name, Queued.Payload);
+	}
+}
+
+void UBluEye::HandleScriptEvent(const FString& EventName, const FBluEventPayload& Payload)
+{
+	if (EventName == BluScripts::EvaluateResultName)
+	{
+		int32 RequestId = 0;
+		FBluEvaluateResult Result;
+		if (!ParseEvaluateMessage(Payload, RequestId, Result))
+		{
+			UE_LOG(LogBlu, Warning, TEXT("Malformed EvaluateJS result: %s"), *Payload.ToString());
+			return;
+		}
+
+		// Only the eye that asked is waiting on it
+		if (const FBluSharedBrowser* Shared = SharedBrowsers.Find(SharedKey))
+		{
+			for (UBluEye* Eye : Shared->Eyes)
+			{
+				if (Eye->CompleteEvaluation(RequestId, Result))
+				{
+					break;
+				}
+			}
+			return;
+		}
+
+		CompleteEvaluation(RequestId, Result);
+		return;
+	}
+
+	if (EventName == BluScripts::BulkEventName)
+	{
+		TSharedPtr<FJsonObject> Message = ReadMessageObject(Payload);
+		FString Channel;
+		FString Encoded;
+		TArray<uint8> Data;
+		if (!Message.IsValid() || !Message->TryGetStringField(TEXT("channel"), Channel) || !Message->TryGetStringField(TEXT("data"), Encoded) || !FBase64::Decode(Encoded, Data))
+		{
+			UE_LOG(LogBlu, Warning, TEXT("Malformed bulk data on %s"), *Channel);
+			return;
+		}
+
+		DispatchBulkData(FName(*Channel), Data);
+		return;
+	}
+
+	if (EventName == BluScripts::QueryEventName)
+	{
+		TSharedPtr<FJsonObject> Message = ReadMessageObject(Payload);
+		int32 PageQueryId = 0;
+		FString QueryName;
+		if (!Message.IsValid() || !Message->TryGetNumberField(TEXT("id"), PageQueryId) || !Message->TryGetStringField(TEXT("name"), QueryName))
+		{
+			UE_LOG(LogBlu, Warning, TEXT("Malformed query: %s"), *Payload.ToString());
+			return;
+		}
+
+		const FName InternedName(*QueryName, FNAME_Find);
+		TSharedPtr<FJsonValue> QueryPayload = Message->TryGetField(TEXT("payload"));
+
+		// The first eye sharing our browser with a handler answers it
+		if (!InternedName.IsNone())
+		{
+			if (const FBluSharedBrowser* Shared = SharedBrowsers.Find(SharedKey))
+			{
+				for (UBluEye* Eye : Shared->Eyes)
+				{
+					if (Eye->HasQueryHandler(InternedName))
+					{
+						Eye->StartQuery(PageQueryId, InternedName, QueryPayload);
+						return;
+					}
+				}
+			}
+			else if (HasQueryHandler(InternedName))
+			{
+				StartQuery(PageQueryId, InternedName, QueryPayload);
+				return;
+			}
+		}
+
+		SendQueryResponse(PageQueryId, false, MakeShared<FJsonValueString>(FString::Printf(TEXT("No handler for query '%s'"), *QueryName)));
+		return;
+	}
+
+	// Names only exist if something subscribed to them, so don't add new ones for every event.
+	// FNames ignore case, and outside the editor they don't keep it either, so "update" reaches listeners of "Update"
+	const FName InternedName(*EventName, FNAME_Find);
+
+	// Every eye sharing our browser gets the page's events
+	if (const FBluSharedBrowser* Shared = SharedBrowsers.Find(SharedKey))
+	{
+		for (UBluEye* Eye : Shared->Eyes)
+		{
+			Eye->DeliverScriptEvent(EventName, InternedName, Payload);
+		}
+		return;
+	}
+
+	DeliverScriptEvent(EventName, InternedName, Payload);
+}
+
+void UBluEye::DeliverScriptEvent(const FString& EventName, FName InternedName, const FBluEventPayload& Payload)
+{
+	TypedScriptEventEmitter.Broadcast(EventName, Payload);
+
+	// Only pay for the string form if a Blueprint wants it
+	if (ScriptEventEmitter.IsBound())
+	{
+		ScriptEventEmitter.Broadcast(EventName, Payload.ToString());
+	}
+
+	TArray<FBluNamedScriptEvent>* Callbacks = InternedName.IsNone() ? nullptr : ScriptEventBindings.Find(InternedName);
+	FBluNamedTypedScriptEvent* TypedCallbacks = InternedName.IsNone() ? nullptr : TypedScriptEventBindings.Find(InternedName);
+
+	const bool bHasCallbacks = Callbacks && Callbacks->Num() > 0;
+	const bool bHasTypedCallbacks = TypedCallbacks && TypedCallbacks->IsBound();
+
+	if (!bHasCallbacks && !bHasTypedCallbacks)
+	{
+		ScriptEventsFiltered++;
+		return;
+	}
+
+	ScriptEventsDispatched++;
+
+	if (bHasTypedCallbacks)
+	{
+		TypedCallbacks->Broadcast(Payload);
+	}
+
+	if (bHasCallbacks)
+	{
+		// Copy in case a callback binds or unbinds while we're calling them
+		const TArray<FBluNamedScriptEvent> CallbacksCopy = *Callbacks;
+		const FString Message = Payload.ToString();
+
+		for (const FBluNamedScriptEvent& Callback : CallbacksCopy)
+		{
+			Callback.ExecuteIfBound(Message);
+		}
+	}
+}
+
+void UBluEye::DispatchLogMessage(const FString& LogText)
+{
+	NativeLogEventEmitter.Broadcast(LogText);
+
+	if (LogEventEmitter.IsBound())
+	{
+		LogEventEmitter.Broadcast(LogText);
+	}
+}
+
+void UBluEye::DispatchDownloadUpdated(const FString& Url, float Percentage, bool bComplete)
+{
+	NativeDownloadUpdated.Broadcast(Url, Percentage);
+
+	if (DownloadUpdated.IsBound())
+	{
+		DownloadUpdated.Broadcast(Url, Percentage);
+	}
+
+	if (!bComplete)
+	{
+		return;
+	}
+
+	NativeDownloadComplete.Broadcast(Url);
+
+	if (DownloadComplete.IsBound())
+	{
+		DownloadComplete.Broadcast(Url);
+	}
+}
+
+void UBluEye::BindScriptEvent(FName EventName, const FBluNamedScriptEvent& Callback)
+{
+	TArray<FBluNamedScriptEvent>& Callbacks = ScriptEventBindings.FindOrAdd(EventName);
+
+	// Drop callbacks whose objects have gone away while we're here
+	Callbacks.RemoveAll([](const FBluNamedScriptEvent& Existing) { return !Existing.IsBound(); });
+	Callbacks.AddUnique(Callback);
+}
+
+void UBluEye::UnbindScriptEvent(FName EventName, const FBluNamedScriptEvent& Callback)
+{
+	if (TArray<FBluNamedScriptEvent>* Callbacks = ScriptEventBindings.Find(EventName))
+	{
+		Callbacks->Remove(Callback);
+
+		if (Callbacks->Num() == 0)
+		{
+			ScriptEventBindings.Remove(EventName);
+		}
+	}
+}
+
+FBluNamedTypedScriptEvent& UBluEye::OnScriptEvent(FName EventName)
+{
+	return TypedScriptEventBindings.FindOrAdd(EventName);
+}
+
+void UBluEye::GetScriptEventStats(int64& Dispatched, int64& Filtered) const
+{
+	Dispatched = ScriptEventsDispatched;
+	Filtered = ScriptEventsFiltered;
+}
+
+void UBluEye::GetMouseInputStats(int64& MovesReceived, int64& MovesSent, int64& WheelsReceived, int64& WheelsSent) const
+{
+	MovesReceived = MouseMovesReceived;
+	MovesSent = MouseMovesSent;
+	WheelsReceived = MouseWheelsReceived;
+	WheelsSent = MouseWheelsSent;
+}
+
+void UBluEye::InjectPageScripts(CefRefPtr<CefBrowser> LoadedBrowser)
+{
+	CefRefPtr<CefFrame> Frame = LoadedBrowser->GetMainFrame();
+	if (Frame->GetURL() == "about:blank")
+	{
+		return;
+	}
+
+	FString Script;
+
+	if (Settings.bBatchScriptEvents)
+	{
+		Script += BluScripts::EventBatching;
+		for (const FString& EventName : Settings.CoalescedScriptEvents)
+		{
+			Script += FString::Printf(TEXT("blui.coalesce('%s');\n"), *EventName.ReplaceCharWithEscapedChar());
+		}
+	}
+
+	Script += BluScripts::Query;
+	Script += BluScripts::BulkData;
+	Script += BluScripts::MessagePack;
+	Script += BluScripts::Models;
+	Script += BluScripts::JsonState;
+	Script += BluScripts::Ready;
+
+	Frame->ExecuteJavaScript(*Script, Frame->GetURL(), 0);
+}
+
+void UBluEye::OnRenderProcessTerminated(CefRefPtr<CefBrowser> TerminatedBrowser, int32 Status)
+{
+	if (PreloadBrowser && PreloadBrowser->IsSame(TerminatedBrowser))
+	{
+		UE_LOG(LogBlu, Warning, TEXT("Preload render process terminated (status %d)"), Status);
+		DiscardPreloaded();
+		return;
+	}
+
+	if (StandbyBrowser && StandbyBrowser->IsSame(TerminatedBrowser))
+	{
+		UE_LOG(LogBlu, Warning, TEXT("Standby render process terminated (status %d)"), Status);
+		FBluTeardownManager::QueueClose(StandbyBrowser, StandbyClient);
+		StandbyBrowser = nullptr;
+		StandbyClient = nullptr;
+		StandbyRenderer = nullptr;
+		SpawnStandbyBrowser();
+		return;
+	}
+
+	if (!Browser || !Browser->IsSame(TerminatedBrowser))
+	{
+		return;
+	}
+
+	UE_LOG(LogBlu, Warning, TEXT("Render process terminated (status %d) while showing %s"), Status, *LastLoadedURL);
+
+	if (!Settings.bEnableCrashRecovery)
+	{
+		CancelPageRequests();
+		return;
+	}
+
+	RecoveryStartTime = FPlatformTime::Seconds();
+
+	// No warm browser around, this is going to be a cold start
+	if (!StandbyBrowser)
+	{
+		SpawnStandbyBrowser();
+	}
+
+	SwapActiveBrowser(StandbyBrowser, StandbyClient, StandbyRenderer);
+	StandbyBrowser = nullptr;
+	StandbyClient = nullptr;
+	StandbyRenderer = nullptr;
+
+	// Keep showing the last good frame until the page is back
+	Renderer->bPaintingEnabled = false;
+
+	if (!LastLoadedURL.IsEmpty())
+	{
+		Browser->GetMainFrame()->LoadURL(*LastLoadedURL);
+	}
+	else
+	{
+		LoadURL(DefaultURL);
+	}
+
+	// Get the next standby warming up
+	SpawnStandbyBrowser();
+}
+
+void UBluEye::SetCrashRestoreScript(const FString& Script)
+{
+	CrashRestoreScript = Script;
+}
+
+float UBluEye::GetLastRecoveryTime() const
+{
+	return LastRecoveryTime;
+}
+
+void UBluEye::SpawnStandbyBrowser()
+{
+	if (StandbyBrowser)
+	{
+		return;
+	}
+
+	StandbyBrowser = CreateBrowserInstance(TEXT("about:blank"), StandbyRenderer, StandbyClient);
+
+	StandbyRenderer->bPaintingEnabled = false;
+	StandbyBrowser->GetHost()->SetAudioMuted(true);
+	StandbyBrowser->GetHost()->WasHidden(true);
+}
+
+void UBluEye::FinishCrashRecovery()
+{
+	if (!CrashRestoreScript.IsEmpty())
+	{
+		ExecuteJS(CrashRestoreScript);
+	}
+
+	Renderer->bPaintingEnabled = true;
+	Browser->GetHost()->Invalidate(PET_VIEW);
+
+	LastRecoveryTime = FPlatformTime::Seconds() - RecoveryStartTime;
+	RecoveryStartTime = 0.0;
+
+	UE_LOG(LogBlu, Log, TEXT("Recovered from render process crash in %.3f seconds"), LastRecoveryTime);
+
+	RenderProcessRecovered.Broadcast(LastRecoveryTime);
+}
+
+FString UBluEye::GetCurrentURL()
+{
+	return FString(Browser->GetMainFrame()->GetURL().c_str());
+}
+
+void UBluEye::SetZoom(const float Scale /*= 1*/)
+{
+	Browser->GetHost()->SetZoomLevel(Scale);
+}
+
+float UBluEye::GetZoom()
+{
+	return Browser->GetHost()->GetZoomLevel();
+}
+
+void UBluEye::DownloadFile(const FString& FileUrl)
+{
+	Browser->GetHost()->StartDownload(*FileUrl);
+	//Todo: ensure downloading works in some way, shape or form?
+}
+
+bool UBluEye::IsBrowserLoading()
+{
+	return Browser->IsLoading();
+}
+
+void UBluEye::ReloadBrowser(bool IgnoreCache)
+{
+	FlushJS();
+
+	if (IgnoreCache)
+	{
+		return Browser->ReloadIgnoreCache();
+	}
+
+	Browser->Reload();
+
+}
+
+void UBluEye::NavBack()
+{
+	FlushJS();
+
+	if (Browser->CanGoBack())
+	{
+		Browser->GoBack();
+	}
+
+}
+
+void UBluEye::NavForward()
+{
+	FlushJS();
+
+	if (Browser->CanGoForward())
+	{
+		Browser->GoForward();
+	}
+
+}
+
+UTexture2D* UBluEye::ResizeBrowser(const int32 NewWidth, const int32 NewHeight)
+{
+
+	if (NewWidth <= 0 || NewHeight <= 0)
+	{
+		// We can't do this, just do nothing.
+		UE_LOG(LogBlu, Log, TEXT("Can't resize when one or both of the sizes are <= 0!"));
+		return Texture;
+	}
+
+	const FBluSharedBrowser* Shared = SharedBrowsers.Find(SharedKey);
+	if (Shared && Shared->Eyes.Num() > 1)
+	{
+		UE_LOG(LogBlu, Warning, TEXT("Can't resize a browser that is shared with other BluEyes!"));
+		return Texture;
+	}
+
+	// Disable the web view while we resize
+	bEnabled = false;
+
+	// Set our new Width and Height
+	Settings.ViewSize.X = NewWidth;
+	Settings.ViewSize.Y = NewHeight;
+	
+	// Update our render handler
+	Renderer->Width = NewWidth;
+	Renderer->Height = NewHeight;
+
+	bValidTexture = false;
+
+	Texture = UTexture2D::CreateTransient(Settings.ViewSize.X, Settings.ViewSize.Y, PF_B8G8R8A8);
+	Texture->AddToRoot();
+	Texture->UpdateResource();
+
+	bValidTexture = true;
+
+	// Eyes asking for our old size shouldn't get this browser
+	RekeySharedBrowser(SharedURL);
+
+	// Let the browser's host know we resized it
+	Browser->GetHost()->WasResized();
+
+	// Now we can keep going
+	bEnabled = true;
+
+	UE_LOG(LogBlu, Log, TEXT("BluEye was resized!"))
+
+	return Texture;
 
 }
 
 UTexture2D* UBluEye::CropWindow(const int32 Y, const int32 X, const int32 NewWidth, const int32 NewHeight)
 {
+	// The renderer belongs to every eye sharing the browser, only our texture would follow the new size
+	const FBluSharedBrowser* Shared = SharedBrowsers.Find(SharedKey);
+	if (Shared && Shared->Eyes.Num() > 1)
+	{
+		UE_LOG(LogBlu, Warning, TEXT("Can't crop a browser that is shared with other BluEyes!"));
+		return Texture;
+	}
+
 	// Disable the web view while we resize
 	bEnabled = false;
 
@@ -367,6 +1756,8 @@ UTexture2D* UBluEye::CropWindow(const int32 Y, const int32 X, const int32 NewWid
 	Settings.ViewSize.X = NewWidth;
 	Settings.ViewSize.Y = NewHeight;
 
+	RekeySharedBrowser(SharedURL);
+
 	// Update our render handler
 	Renderer->Width = NewWidth;
 	Renderer->Height = NewHeight;
@@ -414,11 +1805,21 @@ UBluEye* UBluEye::SetProperties(const int32 SetWidth,
 void UBluEye::TriggerMouseMove(const FVector2D& Pos, const float Scale)
 {
 
-	MouseEvent.x = Pos.X / Scale;
-	MouseEvent.y = Pos.Y / Scale;
+	if (!CanSendInput())
+	{
+		return;
+	}
+
+	MouseMovesReceived++;
 
-	Browser->GetHost()->SetFocus(true);
-	Browser->GetHost()->SendMouseMoveEvent(MouseEvent, false);
+	// A move after a scroll has to reach the page after it
+	if (bPendingMouseWheel)
+	{
+		FlushPendingMouse();
+	}
+
+	PendingMousePos = FIntPoint(int32(Pos.X / Scale), int32(Pos.Y / Scale));
+	bPendingMouseMove = true;
 
 }
 
@@ -436,6 +1837,13 @@ void UBluEye::TriggerRightClick(const FVector2D& Pos, const float Scale)
 
 void UBluEye::TriggerLeftMouseDown(const FVector2D& Pos, const float Scale)
 {
+	if (!CanSendInput())
+	{
+		return;
+	}
+
+	FlushPendingMouse();
+
 	MouseEvent.x = Pos.X / Scale;
 	MouseEvent.y = Pos.Y / Scale;
 
@@ -444,6 +1852,13 @@ void UBluEye::TriggerLeftMouseDown(const FVector2D& Pos, const float Scale)
 
 void UBluEye::TriggerRightMouseDown(const FVector2D& Pos, const float Scale)
 {
+	if (!CanSendInput())
+	{
+		return;
+	}
+
+	FlushPendingMouse();
+
 	MouseEvent.x = Pos.X / Scale;
 	MouseEvent.y = Pos.Y / Scale;
 
@@ -452,6 +1867,13 @@ void UBluEye::TriggerRightMouseDown(const FVector2D& Pos, const float Scale)
 
 void UBluEye::TriggerLeftMouseUp(const FVector2D& Pos, const float Scale)
 {
+	if (!CanSendInput())
+	{
+		return;
+	}
+
+	FlushPendingMouse();
+
 	MouseEvent.x = Pos.X / Scale;
 	MouseEvent.y = Pos.Y / Scale;
 
@@ -460,6 +1882,13 @@ void UBluEye::TriggerLeftMouseUp(const FVector2D& Pos, const float Scale)
 
 void UBluEye::TriggerRightMouseUp(const FVector2D& Pos, const float Scale)
 {
+	if (!CanSendInput())
+	{
+		return;
+	}
+
+	FlushPendingMouse();
+
 	MouseEvent.x = Pos.X / Scale;
 	MouseEvent.y = Pos.Y / Scale;
 
@@ -468,15 +1897,235 @@ void UBluEye::TriggerRightMouseUp(const FVector2D& Pos, const float Scale)
 
 void UBluEye::TriggerMouseWheel(const float MouseWheelDelta, const FVector2D& Pos, const float Scale)
 {
-	MouseEvent.x = Pos.X / Scale;
-	MouseEvent.y = Pos.Y / Scale;
+	if (!CanSendInput())
+	{
+		return;
+	}
+
+	MouseWheelsReceived++;
+
+	PendingWheelPos = FIntPoint(int32(Pos.X / Scale), int32(Pos.Y / Scale));
+	PendingWheelDelta += MouseWheelDelta;
+	bPendingMouseWheel = true;
+}
+
+void UBluEye::FlushPendingMouse()
+{
+	if (!bPendingMouseMove && !bPendingMouseWheel)
+	{
+		return;
+	}
+
+	if (!CanSendInput())
+	{
+		bPendingMouseMove = false;
+		bPendingMouseWheel = false;
+		PendingWheelDelta = 0.f;
+		return;
+	}
+
+	if (bPendingMouseMove)
+	{
+		bPendingMouseMove = false;
+
+		MouseEvent.x = PendingMousePos.X;
+		MouseEvent.y = PendingMousePos.Y;
+		SendMouseMove(MouseEvent);
+	}
+
+	if (bPendingMouseWheel)
+	{
+		bPendingMouseWheel = false;
+
+		MouseEvent.x = PendingWheelPos.X;
+		MouseEvent.y = PendingWheelPos.Y;
+		SendMouseWheel(MouseEvent, PendingWheelDelta);
+		PendingWheelDelta = 0.f;
+	}
+}
+
+void UBluEye::SendMouseMove(const CefMouseEvent& Event)
+{
+	if (!bHasFocus)
+	{
+		Browser->GetHost()->SetFocus(true);
+		bHasFocus = true;
+	}
+
+	Browser->GetHost()->SendMouseMoveEvent(Event, false);
+	MouseMovesSent++;
+}
+
+void UBluEye::SendMouseWheel(const CefMouseEvent& Event, float Delta)
+{
+	Browser->GetHost()->SendMouseWheelEvent(Event, Delta * 10, Delta * 10);
+	MouseWheelsSent++;
+}
+
+void UBluEye::SubmitInput(const TArray<FBluInputEvent>& Events)
+{
+	if (!CanSendInput())
+	{
+		return;
+	}
+
+	SubmittedInput.Append(Events);
+}
+
+void UBluEye::DeliverSubmittedInput()
+{
+	if (SubmittedInput.Num() == 0)
+	{
+		return;
+	}
+
+	// Taken first so nothing is left behind if we can't send
+	TArray<FBluInputEvent> Events = MoveTemp(SubmittedInput);
+	SubmittedInput.Reset();
+
+	if (!CanSendInput())
+	{
+		return;
+	}
+
+	// Loose input sent before this batch has to arrive first
+	FlushPendingMouse();
+
+	Algo::StableSortBy(Events, &FBluInputEvent::Sequence);
+
+	for (int32 Index = 0; Index < Events.Num(); Index++)
+	{
+		FBluInputEvent& Event = Events[Index];
+
+		if (Event.Type == EBluInputType::MouseMove)
+		{
+			MouseMovesReceived++;
+			if (Events.IsValidIndex(Index + 1) && Events[Index + 1].Type == EBluInputType::MouseMove)
+			{
+				continue;
+			}
+		}
+		else if (Event.Type == EBluInputType::MouseWheel)
+		{
+			MouseWheelsReceived++;
+			if (Events.IsValidIndex(Index + 1) && Events[Index + 1].Type == EBluInputType::MouseWheel)
+			{
+				// The next one goes out with both deltas, at its own position
+				Events[Index + 1].WheelDelta += Event.WheelDelta;
+				continue;
+			}
+		}
 
-	Browser->GetHost()->SendMouseWheelEvent(MouseEvent, MouseWheelDelta * 10, MouseWheelDelta * 10);
+		SendInputEvent(Event);
+	}
+}
+
+void UBluEye::SendInputEvent(const FBluInputEvent& Event)
+{
+	int32 Mods = 0;
+	if (Event.bShiftDown)
+	{
+		Mods |= EVENTFLAG_SHIFT_DOWN;
+	}
+	if (Event.bControlDown)
+	{
+		Mods |= EVENTFLAG_CONTROL_DOWN;
+	}
+	if (Event.bAltDown)
+	{
+		Mods |= EVENTFLAG_ALT_DOWN;
+	}
+	if (Event.bCommandDown)
+	{
+		Mods |= EVENTFLAG_COMMAND_DOWN;
+	}
+
+	cef_mouse_button_type_t Button = MBT_LEFT;
+	if (Event.Button == EBluMouseButton::Middle)
+	{
+		Button = MBT_MIDDLE;
+	}
+	else if (Event.Button == EBluMouseButton::Right)
+	{
+		Button = MBT_RIGHT;
+	}
+
+	// Our own events rather than the MouseEvent and KeyEvent members, so this batch's modifiers don't stick to later Trigger* calls
+	CefMouseEvent BatchMouseEvent;
+	BatchMouseEvent.x = int32(Event.Position.X / Event.Scale);
+	BatchMouseEvent.y = int32(Event.Position.Y / Event.Scale);
+	BatchMouseEvent.modifiers = Mods;
+
+	CefKeyEvent BatchKeyEvent;
+	BatchKeyEvent.modifiers = Mods;
+	BatchKeyEvent.native_key_code = Event.KeyCode;
+	BatchKeyEvent.windows_key_code = Event.KeyCode;
+
+	switch (Event.Type)
+	{
+	case EBluInputType::MouseMove:
+		SendMouseMove(BatchMouseEvent);
+		break;
+	case EBluInputType::MouseWheel:
+		SendMouseWheel(BatchMouseEvent, Event.WheelDelta);
+		break;
+	case EBluInputType::MouseDown:
+		Browser->GetHost()->SendMouseClickEvent(BatchMouseEvent, Button, false, 1);
+		break;
+	case EBluInputType::MouseUp:
+		Browser->GetHost()->SendMouseClickEvent(BatchMouseEvent, Button, true, 1);
+		break;
+	case EBluInputType::MouseClick:
+		Browser->GetHost()->SendMouseClickEvent(BatchMouseEvent, Button, false, 1);
+		Browser->GetHost()->SendMouseClickEvent(BatchMouseEvent, Button, true, 1);
+		break;
+	case EBluInputType::KeyDown:
+		BatchKeyEvent.type = KEYEVENT_KEYDOWN;
+		Browser->GetHost()->SendKeyEvent(BatchKeyEvent);
+		break;
+	case EBluInputType::KeyUp:
+		BatchKeyEvent.type = KEYEVENT_KEYUP;
+		Browser->GetHost()->SendKeyEvent(BatchKeyEvent);
+		break;
+	case EBluInputType::KeyPress:
+		BatchKeyEvent.type = KEYEVENT_KEYDOWN;
+		Browser->GetHost()->SendKeyEvent(BatchKeyEvent);
+		BatchKeyEvent.type = KEYEVENT_KEYUP;
+		Browser->GetHost()->SendKeyEvent(BatchKeyEvent);
+		break;
+	case EBluInputType::Char:
+	{
+		if (Event.Character.IsEmpty())
+		{
+			break;
+		}
+
+		const TCHAR Char = Event.Character[0];
+#if PLATFORM_MAC
+		BatchKeyEvent.character = Char;
+#else
+		BatchKeyEvent.windows_key_code = Char;
+		BatchKeyEvent.native_key_code = Char;
+#endif
+		BatchKeyEvent.type = KEYEVENT_CHAR;
+		Browser->GetHost()->SendKeyEvent(BatchKeyEvent);
+		break;
+	}
+	default:
+		break;
+	}
 }
 
 void UBluEye::KeyDown(FKeyEvent InKey)
 {
 
+	if (!CanSendInput())
+	{
+		return;
+	}
+
+	FlushPendingMouse();
+
 	ProcessKeyMods(InKey);
 	ProcessKeyCode(InKey);
 
@@ -488,6 +2137,13 @@ void UBluEye::KeyDown(FKeyEvent InKey)
 void UBluEye::KeyUp(FKeyEvent InKey)
 {
 
+	if (!CanSendInput())
+	{
+		return;
+	}
+
+	FlushPendingMouse();
+
 	ProcessKeyMods(InKey);
 	ProcessKeyCode(InKey);
 
@@ -514,6 +2170,13 @@ void UBluEye::ProcessKeyCode(FKeyEvent InKey)
 void UBluEye::CharKeyInput(FCharacterEvent CharEvent)
 {
 
+	if (!CanSendInput())
+	{
+		return;
+	}
+
+	FlushPendingMouse();
+
 	// Process keymods like usual
 	ProcessKeyMods(CharEvent);
 
@@ -531,6 +2194,13 @@ void UBluEye::CharKeyInput(FCharacterEvent CharEvent)
 
 void UBluEye::CharKeyDownUp(FCharacterEvent CharEvent)
 {
+	if (!CanSendInput())
+	{
+		return;
+	}
+
+	FlushPendingMouse();
+
 	// Process keymods like usual
 	ProcessKeyMods(CharEvent);
 
@@ -581,6 +2251,13 @@ void UBluEye::SpecialKeyPress(EBluSpecialKeys Key, bool LeftShiftDown,
 	bool CapsLocksOn)
 {
 
+	if (!CanSendInput())
+	{
+		return;
+	}
+
+	FlushPendingMouse();
+
 	int32 KeyValue = Key;
 
 	KeyEvent.windows_key_code = KeyValue;
@@ -627,22 +2304,213 @@ void UBluEye::SpawnTickEventLoopIfNeeded()
 {
 	if (!EventLoopData.DelegateHandle.IsValid())
 	{
-		EventLoopData.DelegateHandle = FTSTicker::GetCoreTicker().AddTicker(FTickerDelegate::CreateLambda([&](float DeltaTime)
+		// Don't capture this, the eye that spawned the loop may be destroyed before the others
+		const bool bDebugLogTick = Settings.bDebugLogTick;
+		EventLoopData.DelegateHandle = FTSTicker::GetCoreTicker().AddTicker(FTickerDelegate::CreateLambda([bDebugLogTick](float DeltaTime)
 		{
 			if (EventLoopData.bShouldTickEventLoop)
 			{
-				if (Settings.bDebugLogTick)
+				if (bDebugLogTick)
 				{
 					UE_LOG(LogTemp, Log, TEXT("Delta: %1.2f"), DeltaTime);
 				}
-				BluManager::DoBluMessageLoop();
+				RunMessageLoop(DeltaTime);
 			}
 			
 			return true;
 		}));
 	}
 
-	EventLoopData.EyeCount++;
+	EventLoopData.Eyes.AddUnique(this);
+}
+
+void UBluEye::RunMessageLoop(float DeltaTime)
+{
+	// Let every eye send what it batched up this frame before CEF does its work.
+	// Ticking runs listeners that may close or create eyes, so walk a copy and skip any that went away meanwhile
+	TArray<TWeakObjectPtr<UBluEye>, TInlineAllocator<8>> Eyes;
+	Eyes.Reserve(EventLoopData.Eyes.Num());
+	for (UBluEye* Eye : EventLoopData.Eyes)
+	{
+		Eyes.Add(Eye);
+	}
+
+	for (const TWeakObjectPtr<UBluEye>& WeakEye : Eyes)
+	{
+		UBluEye* Eye = WeakEye.Get();
+		if (!Eye || Eye->HasAnyFlags(RF_BeginDestroyed) || !EventLoopData.Eyes.Contains(Eye))
+		{
+			continue;
+		}
+		Eye->TickBeforeMessageLoop(DeltaTime);
+	}
+
+	BluManager::DoBluMessageLoop();
+}
+
+void UBluEye::TickBeforeMessageLoop(float DeltaTime)
+{
+	FlushPendingMouse();
+	DeliverSubmittedInput();
+	DeliverQueuedScriptEvents();
+	PushModelChanges();
+	ResendJsonStates();
+	FlushJS();
+	ExpireEvaluations();
+}
+
+FString UBluEye::MakeSharedKey() const
+{
+	return MakeSharedKey(DefaultURL);
+}
+
+FString UBluEye::MakeSharedKey(const FString& URL) const
+{
+	return FString::Printf(TEXT("%s|%dx%d|%d|%d|%d|%.2f"),
+		*URL,
+		int32(Settings.ViewSize.X),
+		int32(Settings.ViewSize.Y),
+		Settings.bIsTransparent,
+		Settings.bEnableWebGL,
+		Settings.bAudioMuted,
+		Settings.FrameRate);
+}
+
+void UBluEye::RekeySharedBrowser(const FString& URL)
+{
+	if (SharedKey.IsEmpty())
+	{
+		return;
+	}
+
+	FString NewKey = MakeSharedKey(URL);
+	if (NewKey == SharedKey)
+	{
+		return;
+	}
+
+	FBluSharedBrowser* Shared = SharedBrowsers.Find(SharedKey);
+	if (!Shared)
+	{
+		return;
+	}
+
+	// Another browser already shows that page, make ours a key nothing new will ask for
+	if (SharedBrowsers.Contains(NewKey))
+	{
+		NewKey += FString::Printf(TEXT("|%p"), this);
+	}
+
+	FBluSharedBrowser Moved = MoveTemp(*Shared);
+	SharedBrowsers.Remove(SharedKey);
+
+	for (UBluEye* Eye : Moved.Eyes)
+	{
+		Eye->SharedKey = NewKey;
+		Eye->SharedURL = URL;
+	}
+
+	SharedBrowsers.Add(NewKey, MoveTemp(Moved));
+}
+
+bool UBluEye::AttachToSharedBrowser()
+{
+	SharedKey = MakeSharedKey();
+	SharedURL = DefaultURL;
+
+	FBluSharedBrowser& Shared = SharedBrowsers.FindOrAdd(SharedKey);
+	if (Shared.Eyes.Num() == 0)
+	{
+		// We're the first, we'll create the browser and texture for everyone else
+		Shared.Eyes.Add(this);
+		return false;
+	}
+
+	UBluEye* Owner = Shared.Eyes[0];
+
+	Browser = Owner->Browser;
+	ClientHandler = Owner->ClientHandler;
+	Renderer = Owner->Renderer;
+	Texture = Owner->Texture;
+	RenderParams = Owner->RenderParams;
+	bValidTexture = Owner->bValidTexture;
+
+	Shared.Eyes.Add(this);
+
+	// Our material samples the owner's texture
+	ResetMatInstance();
+
+	return true;
+}
+
+bool UBluEye::ReleaseSharedBrowser()
+{
+	if (SharedKey.IsEmpty())
+	{
+		return false;
+	}
+
+	const FString Key = SharedKey;
+	SharedKey.Empty();
+
+	FBluSharedBrowser* Shared = SharedBrowsers.Find(Key);
+
+	if (!Shared)
+	{
+		return false;
+	}
+
+	const bool bWasOwner = Shared->Eyes.Num() > 0 && Shared->Eyes[0] == this;
+	Shared->Eyes.Remove(this);
+
+	if (Shared->Eyes.Num() == 0)
+	{
+		SharedBrowsers.Remove(Key);
+		return false;
+	}
+
+	// Hand the browser over to the next eye so it keeps receiving paints and events
+	if (bWasOwner)
+	{
+		Shared->Eyes[0]->AdoptSharedBrowser(this);
+	}
+
+	return true;
+}
+
+void UBluEye::AdoptSharedBrowser(UBluEye* PreviousOwner)
+{
+	Renderer->ParentUI = this;
+
+	// Keep crash recovery working for the eyes still sharing the browser
+	if (!StandbyBrowser && PreviousOwner->StandbyBrowser)
+	{
+		StandbyBrowser = PreviousOwner->StandbyBrowser;
+		StandbyClient = PreviousOwner->StandbyClient;
+		StandbyRenderer = PreviousOwner->StandbyRenderer;
+		StandbyRenderer->ParentUI = this;
+
+		PreviousOwner->StandbyBrowser = nullptr;
+		PreviousOwner->StandbyClient = nullptr;
+		PreviousOwner->StandbyRenderer = nullptr;
+	}
+
+	if (CrashRestoreScript.IsEmpty())
+	{
+		CrashRestoreScript = PreviousOwner->CrashRestoreScript;
+	}
+
+	LastLoadedURL = PreviousOwner->LastLoadedURL;
+}
+
+bool UBluEye::CanSendInput() const
+{
+	if (!Browser)
+	{
+		return false;
+	}
+
+	return SharedKey.IsEmpty() || Settings.bSharedInputEnabled;
 }
 
 UTexture2D* UBluEye::GetTexture() const
@@ -698,16 +2566,41 @@ void UBluEye::CloseBrowser()
 
 void UBluEye::BeginDestroy()
 {
-	if (Browser)
+	CancelAllEvaluations();
+
+	// Nothing can be told about these while we're being collected
+	PendingQueries.Empty();
+	QueuedScriptEvents.Empty();
+	bPendingMouseMove = false;
+	bPendingMouseWheel = false;
+	SubmittedInput.Empty();
+
+	DiscardPreloaded();
+
+	// Other eyes still sample our browser and texture, the next owner may also take our standby
+	const bool bStillShared = ReleaseSharedBrowser();
+
+	if (StandbyBrowser)
+	{
+		FBluTeardownManager::QueueClose(StandbyBrowser, StandbyClient);
+		StandbyBrowser = nullptr;
+		StandbyClient = nullptr;
+		StandbyRenderer = nullptr;
+	}
+
+	if (bStillShared)
 	{
-		// Close up the browser
-		Browser->GetHost()->SetAudioMuted(true);
-		Browser->GetMainFrame()->LoadURL("about:blank");
-		//browser->GetMainFrame()->Delete();
-		Browser->GetHost()->CloseDevTools();
-		Browser->GetHost()->CloseBrowser(true);
 		Browser = nullptr;
+		Texture = nullptr;
+		bValidTexture = false;
+	}
 
+	if (Browser)
+	{
+		// Hand the browser off so closing doesn't hold up GC or level transitions
+		FBluTeardownManager::QueueClose(Browser, ClientHandler);
+		Browser = nullptr;
+		ClientHandler = nullptr;
 
 		UE_LOG(LogBlu, Warning, TEXT("Browser Closing"));
 	}
@@ -716,8 +2609,8 @@ void UBluEye::BeginDestroy()
 	SetFlags(RF_BeginDestroyed);
 
 	//Remove our auto-ticking setup
-	EventLoopData.EyeCount--;
-	if (EventLoopData.EyeCount <= 0)
+	EventLoopData.Eyes.Remove(this);
+	if (EventLoopData.Eyes.Num() == 0)
 	{
 		FTSTicker::GetCoreTicker().RemoveTicker(EventLoopData.DelegateHandle);
 		EventLoopData.DelegateHandle = FTSTicker::FDelegateHandle();
@@ -729,3 +2622,8 @@ void UBluEye::SetShouldTickEventLoop(bool ShouldTick /*= true*/)
 {
 	EventLoopData.bShouldTickEventLoop = ShouldTick;
 }
+
+bool UBluEye::IsEventLoopTicking()
+{
+	return EventLoopData.DelegateHandle.IsValid();
+}
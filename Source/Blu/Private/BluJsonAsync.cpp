@@ -0,0 +1,51 @@
+#include "BluJsonAsync.h"
+#include "BluJsonWriter.h"
+#include "Async/Async.h"
+#include "Json.h"
+
+void FBluJsonAsync::Parse(FString JsonString, FParseCallback Callback)
+{
+	Async(EAsyncExecution::TaskGraph, [JsonString = MoveTemp(JsonString), Callback = MoveTemp(Callback)]() mutable
+	{
+		TSharedPtr<FJsonObject> Object;
+		TSharedRef<TJsonReader<TCHAR>> Reader = TJsonReaderFactory<TCHAR>::Create(JsonString);
+		if (!FJsonSerializer::Deserialize(Reader, Object))
+		{
+			Object.Reset();
+		}
+
+		AsyncTask(ENamedThreads::GameThread, [Object = MoveTemp(Object), Callback = MoveTemp(Callback)]()
+		{
+			Callback(Object);
+		});
+	});
+}
+
+void FBluJsonAsync::Serialize(TSharedPtr<FJsonObject> Object, FSerializeCallback Callback)
+{
+	Async(EAsyncExecution::TaskGraph, [Object = MoveTemp(Object), Callback = MoveTemp(Callback)]() mutable
+	{
+		// The writer's buffers are per thread, so this is safe on any worker
+		FString JsonString = Object.IsValid() ? FBluJson::ToString(*Object) : FString();
+
+		// The object goes back with the callback so its last reference is released on the game thread
+		AsyncTask(ENamedThreads::GameThread, [Object = MoveTemp(Object), JsonString = MoveTemp(JsonString), Callback = MoveTemp(Callback)]() mutable
+		{
+			Callback(MoveTemp(JsonString));
+		});
+	});
+}
+
+TFuture<TSharedPtr<FJsonValue>> FBluJsonAsync::ParseValue(FString JsonString)
+{
+	return Async(EAsyncExecution::TaskGraph, [JsonString = MoveTemp(JsonString)]()
+	{
+		TSharedPtr<FJsonValue> Value;
+		TSharedRef<TJsonReader<TCHAR>> Reader = TJsonReaderFactory<TCHAR>::Create(JsonString);
+		if (!FJsonSerializer::Deserialize(Reader, Value))
+		{
+			Value.Reset();
+		}
+		return Value;
+	});
+}
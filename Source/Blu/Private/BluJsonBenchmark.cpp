@@ -0,0 +1,248 @@
+#include "BluJsonTape.h"
+#include "BluJsonPatch.h"
+#include "BluJsonWriter.h"
+#include "BluMsgPack.h"
+#include "IBlu.h"
+#include "Json.h"
+#include "HAL/IConsoleManager.h"
+
+/**
+ * Console benchmarks for BLUI's JSON paths, run them in a packaged build for meaningful numbers.
+ * blui.BenchJson [SizeKB] [Iterations]: full FJsonObject parse against the lazy tape, reading two fields each time
+ * blui.BenchJsonPatch [Players] [Iterations] [ChangedPlayers]: resending a whole state document against sending a patch of it
+ * blui.BenchMsgPack [Players] [Iterations]: JSON text against MessagePack for the same state document, both ways
+ */
+namespace BluJsonBenchmark
+{
+	// Something shaped like what pages send us: a small header and a long list of records
+	FString MakePayload(int32 TargetBytes)
+	{
+		FString Payload = TEXT("{\"header\":{\"id\":42,\"name\":\"Leaderboard \\\"weekly\\\"\",\"live\":true},\"rows\":[");
+
+		for (int32 Row = 0; Payload.Len() < TargetBytes; Row++)
+		{
+			if (Row > 0)
+			{
+				Payload += TEXT(",");
+			}
+			Payload += FString::Printf(TEXT("{\"rank\":%d,\"player\":\"Player_%d\",\"score\":%.3f,\"tags\":[\"a\",\"b\"],\"online\":%s}"),
+				Row, Row, Row * 13.37, (Row % 2) ? TEXT("true") : TEXT("false"));
+		}
+
+		Payload += TEXT("],\"total\":1234}");
+		return Payload;
+	}
+
+	void Run(const TArray<FString>& Args)
+	{
+		const int32 SizeKB = Args.Num() > 0 ? FMath::Max(1, FCString::Atoi(*Args[0])) : 200;
+		const int32 Iterations = Args.Num() > 1 ? FMath::Max(1, FCString::Atoi(*Args[1])) : 20;
+
+		const FString Payload = MakePayload(SizeKB * 1024);
+		const FTCHARToUTF8 Utf8Payload(*Payload, Payload.Len());
+
+		double Checksum = 0.0;
+
+		// What UBluJsonObj::Init does
+		double Start = FPlatformTime::Seconds();
+		for (int32 Iteration = 0; Iteration < Iterations; Iteration++)
+		{
+			TSharedPtr<FJsonObject> Object;
+			TSharedRef<TJsonReader<TCHAR>> Reader = TJsonReaderFactory<TCHAR>::Create(Payload);
+			FJsonSerializer::Deserialize(Reader, Object);
+			Checksum += Object->GetNumberField(TEXT("total"));
+			Checksum += Object->GetObjectField(TEXT("header"))->GetStringField(TEXT("name")).Len();
+		}
+		const double EagerMs = (FPlatformTime::Seconds() - Start) * 1000.0 / Iterations;
+
+		// Lazy from an FString, includes the UTF-8 conversion
+		Start = FPlatformTime::Seconds();
+		for (int32 Iteration = 0; Iteration < Iterations; Iteration++)
+		{
+			FBluJsonTape Tape;
+			Tape.Parse(Payload);
+			Checksum += Tape.GetNumber(Tape.FindField(FBluJsonTape::RootIndex, TEXT("total")));
+			Checksum += Tape.GetString(Tape.FindField(Tape.FindField(FBluJsonTape::RootIndex, TEXT("header")), TEXT("name"))).Len();
+		}
+		const double LazyStringMs = (FPlatformTime::Seconds() - Start) * 1000.0 / Iterations;
+
+		// Lazy from bytes that are already UTF-8
+		Start = FPlatformTime::Seconds();
+		for (int32 Iteration = 0; Iteration < Iterations; Iteration++)
+		{
+			FBluJsonTape Tape;
+			Tape.Parse(Utf8Payload.Get(), Utf8Payload.Length());
+			Checksum += Tape.GetNumber(Tape.FindField(FBluJsonTape::RootIndex, TEXT("total")));
+			Checksum += Tape.GetString(Tape.FindField(Tape.FindField(FBluJsonTape::RootIndex, TEXT("header")), TEXT("name"))).Len();
+		}
+		const double LazyUtf8Ms = (FPlatformTime::Seconds() - Start) * 1000.0 / Iterations;
+
+		const double Megabytes = Utf8Payload.Length() / (1024.0 * 1024.0);
+		UE_LOG(LogBlu, Log, TEXT("JSON benchmark, %d KB payload, %d iterations (checksum %.0f)"), Utf8Payload.Length() / 1024, Iterations, Checksum);
+		UE_LOG(LogBlu, Log, TEXT("  FJsonObject:        %.3f ms (%.1f MB/s)"), EagerMs, Megabytes / (EagerMs / 1000.0));
+		UE_LOG(LogBlu, Log, TEXT("  Tape from FString:  %.3f ms (%.1f MB/s)"), LazyStringMs, Megabytes / (LazyStringMs / 1000.0));
+		UE_LOG(LogBlu, Log, TEXT("  Tape from UTF-8:    %.3f ms (%.1f MB/s)"), LazyUtf8Ms, Megabytes / (LazyUtf8Ms / 1000.0));
+	}
+
+	// A game HUD's state: match info plus a record per player with nested stats and an inventory
+	TSharedRef<FJsonObject> MakeState(int32 Players)
+	{
+		TSharedRef<FJsonObject> State = MakeShared<FJsonObject>();
+
+		TSharedRef<FJsonObject> Match = MakeShared<FJsonObject>();
+		Match->SetStringField(TEXT("map"), TEXT("Harbor"));
+		Match->SetNumberField(TEXT("time"), 0.0);
+		Match->SetNumberField(TEXT("scoreRed"), 0.0);
+		Match->SetNumberField(TEXT("scoreBlue"), 0.0);
+		State->SetObjectField(TEXT("match"), Match);
+
+		TArray<TSharedPtr<FJsonValue>> PlayerArray;
+		PlayerArray.Reserve(Players);
+		for (int32 Player = 0; Player < Players; Player++)
+		{
+			TSharedRef<FJsonObject> Record = MakeShared<FJsonObject>();
+			Record->SetStringField(TEXT("name"), FString::Printf(TEXT("Player_%d"), Player));
+			Record->SetStringField(TEXT("team"), (Player % 2) ? TEXT("red") : TEXT("blue"));
+			Record->SetNumberField(TEXT("hp"), 100.0);
+			Record->SetNumberField(TEXT("armor"), 50.0);
+			Record->SetBoolField(TEXT("alive"), true);
+
+			TSharedRef<FJsonObject> Position = MakeShared<FJsonObject>();
+			Position->SetNumberField(TEXT("x"), Player * 10.0);
+			Position->SetNumberField(TEXT("y"), Player * 5.0);
+			Position->SetNumberField(TEXT("z"), 0.0);
+			Record->SetObjectField(TEXT("pos"), Position);
+
+			TArray<TSharedPtr<FJsonValue>> Inventory;
+			for (const TCHAR* Item : { TEXT("rifle"), TEXT("pistol"), TEXT("medkit"), TEXT("grenade") })
+			{
+				Inventory.Add(MakeShared<FJsonValueString>(Item));
+			}
+			Record->SetArrayField(TEXT("inventory"), Inventory);
+
+			PlayerArray.Add(MakeShared<FJsonValueObject>(Record));
+		}
+		State->SetArrayField(TEXT("players"), PlayerArray);
+
+		return State;
+	}
+
+	// What a frame of gameplay changes: the clock, and health and position of a few players
+	void ChangeState(FJsonObject& State, int32 Iteration, int32 ChangedPlayers)
+	{
+		State.GetObjectField(TEXT("match"))->SetNumberField(TEXT("time"), Iteration / 60.0);
+
+		const TArray<TSharedPtr<FJsonValue>>& PlayerArray = State.GetArrayField(TEXT("players"));
+		for (int32 Change = 0; Change < ChangedPlayers && PlayerArray.Num() > 0; Change++)
+		{
+			const TSharedPtr<FJsonObject>& Record = PlayerArray[(Iteration * 7 + Change * 13) % PlayerArray.Num()]->AsObject();
+			Record->SetNumberField(TEXT("hp"), FMath::Max(0.0, Record->GetNumberField(TEXT("hp")) - 1.0));
+			Record->GetObjectField(TEXT("pos"))->SetNumberField(TEXT("x"), Iteration + Change * 0.5);
+		}
+	}
+
+	void RunPatch(const TArray<FString>& Args)
+	{
+		const int32 Players = Args.Num() > 0 ? FMath::Max(1, FCString::Atoi(*Args[0])) : 200;
+		const int32 Iterations = Args.Num() > 1 ? FMath::Max(1, FCString::Atoi(*Args[1])) : 100;
+		const int32 ChangedPlayers = Args.Num() > 2 ? FMath::Max(0, FCString::Atoi(*Args[2])) : 4;
+
+		TSharedRef<FJsonObject> State = MakeState(Players);
+		TSharedRef<FJsonObject> Sent = FBluJsonPatch::CloneObject(*State);
+
+		double FullSeconds = 0.0;
+		double PatchSeconds = 0.0;
+		int64 FullBytes = 0;
+		int64 PatchBytes = 0;
+
+		for (int32 Iteration = 0; Iteration < Iterations; Iteration++)
+		{
+			ChangeState(*State, Iteration, ChangedPlayers);
+
+			// JSONToString and ExecuteJS of everything
+			double Start = FPlatformTime::Seconds();
+			const FString FullJson = FBluJson::ToString(*State);
+			FullSeconds += FPlatformTime::Seconds() - Start;
+			FullBytes += FTCHARToUTF8(*FullJson, FullJson.Len()).Length();
+
+			// What SyncJsonState does
+			Start = FPlatformTime::Seconds();
+			TArray<TSharedPtr<FJsonValue>> Patch = FBluJsonPatch::Diff(*Sent, *State);
+			FBluJsonPatch::Apply(*Sent, Patch);
+			const FString PatchJson = FBluJsonPatch::ToString(Patch);
+			PatchSeconds += FPlatformTime::Seconds() - Start;
+			PatchBytes += FTCHARToUTF8(*PatchJson, PatchJson.Len()).Length();
+		}
+
+		UE_LOG(LogBlu, Log, TEXT("JSON patch benchmark, %d players, %d iterations, %d players changed each"), Players, Iterations, ChangedPlayers);
+		UE_LOG(LogBlu, Log, TEXT("  Full resend:  %.3f ms, %lld bytes per update"), FullSeconds * 1000.0 / Iterations, FullBytes / Iterations);
+		UE_LOG(LogBlu, Log, TEXT("  Patch:        %.3f ms, %lld bytes per update"), PatchSeconds * 1000.0 / Iterations, PatchBytes / Iterations);
+	}
+
+	FAutoConsoleCommand BenchJsonPatchCommand(
+		TEXT("blui.BenchJsonPatch"),
+		TEXT("Compare resending a whole JSON state against sending a patch of it. Usage: blui.BenchJsonPatch [Players] [Iterations] [ChangedPlayers]"),
+		FConsoleCommandWithArgsDelegate::CreateStatic(&RunPatch));
+
+	void RunMsgPack(const TArray<FString>& Args)
+	{
+		const int32 Players = Args.Num() > 0 ? FMath::Max(1, FCString::Atoi(*Args[0])) : 200;
+		const int32 Iterations = Args.Num() > 1 ? FMath::Max(1, FCString::Atoi(*Args[1])) : 100;
+
+		TSharedRef<FJsonObject> State = MakeState(Players);
+		double Checksum = 0.0;
+
+		// UTF-8 JSON, what goes over the bulk channel as text
+		TArray<ANSICHAR> Json;
+		double Start = FPlatformTime::Seconds();
+		for (int32 Iteration = 0; Iteration < Iterations; Iteration++)
+		{
+			Json.Reset();
+			FBluJson::ToUtf8(*State, Json);
+		}
+		const double JsonEncodeMs = (FPlatformTime::Seconds() - Start) * 1000.0 / Iterations;
+
+		// Parsed the way UBluJsonObj::Init does it
+		const FString JsonString = FBluJson::ToString(*State);
+		Start = FPlatformTime::Seconds();
+		for (int32 Iteration = 0; Iteration < Iterations; Iteration++)
+		{
+			TSharedPtr<FJsonObject> Object;
+			TSharedRef<TJsonReader<TCHAR>> Reader = TJsonReaderFactory<TCHAR>::Create(JsonString);
+			FJsonSerializer::Deserialize(Reader, Object);
+			Checksum += Object.IsValid() ? Object->Values.Num() : 0;
+		}
+		const double JsonDecodeMs = (FPlatformTime::Seconds() - Start) * 1000.0 / Iterations;
+
+		TArray<uint8> Packed;
+		Start = FPlatformTime::Seconds();
+		for (int32 Iteration = 0; Iteration < Iterations; Iteration++)
+		{
+			Packed.Reset();
+			FBluMsgPack::Encode(*State, Packed);
+		}
+		const double PackEncodeMs = (FPlatformTime::Seconds() - Start) * 1000.0 / Iterations;
+
+		Start = FPlatformTime::Seconds();
+		for (int32 Iteration = 0; Iteration < Iterations; Iteration++)
+		{
+			TSharedPtr<FJsonObject> Object = FBluMsgPack::Decode(Packed);
+			Checksum += Object.IsValid() ? Object->Values.Num() : 0;
+		}
+		const double PackDecodeMs = (FPlatformTime::Seconds() - Start) * 1000.0 / Iterations;
+
+		UE_LOG(LogBlu, Log, TEXT("MessagePack benchmark, %d players, %d iterations (checksum %.0f)"), Players, Iterations, Checksum);
+		UE_LOG(LogBlu, Log, TEXT("  JSON:         %d bytes, encode %.3f ms, decode %.3f ms"), Json.Num(), JsonEncodeMs, JsonDecodeMs);
+		UE_LOG(LogBlu, Log, TEXT("  MessagePack:  %d bytes, encode %.3f ms, decode %.3f ms"), Packed.Num(), PackEncodeMs, PackDecodeMs);
+	}
+
+	FAutoConsoleCommand BenchMsgPackCommand(
+		TEXT("blui.BenchMsgPack"),
+		TEXT("Compare JSON text against MessagePack for a state document. Usage: blui.BenchMsgPack [Players] [Iterations]"),
+		FConsoleCommandWithArgsDelegate::CreateStatic(&RunMsgPack));
+
+	FAutoConsoleCommand BenchJsonCommand(
+		TEXT("blui.BenchJson"),
+		TEXT("Compare full JSON parsing against BLUI's lazy tape. Usage: blui.BenchJson [SizeKB] [Iterations]"),
+		FConsoleCommandWithArgsDelegate::CreateStatic(&Run));
+}
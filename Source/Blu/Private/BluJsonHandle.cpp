@@ -0,0 +1,286 @@
+#include "BluJsonHandle.h"
+#include "BluJsonObj.h"
+#include "BluJsonWriter.h"
+#include "IBlu.h"
+#include "Json.h"
+
+namespace
+{
+	// Array field of the handle's object, null if there isn't one
+	const TArray<TSharedPtr<FJsonValue>>* FindArray(const FBluJsonHandle& Handle, const FString& Index)
+	{
+		const TArray<TSharedPtr<FJsonValue>>* Values = nullptr;
+		if (Handle.IsValid())
+		{
+			Handle.Object->TryGetArrayField(Index, Values);
+		}
+		return Values;
+	}
+
+	bool CanSet(const FBluJsonHandle& Handle)
+	{
+		if (!Handle.IsValid())
+		{
+			UE_LOG(LogBlu, Warning, TEXT("Tried to set a value through an invalid JSON handle"));
+			return false;
+		}
+		return true;
+	}
+
+	bool CanNest(const FBluJsonHandle& Value)
+	{
+		if (!Value.IsValid())
+		{
+			UE_LOG(LogBlu, Warning, TEXT("Tried to nest an invalid JSON handle"));
+			return false;
+		}
+		return true;
+	}
+}
+
+FBluJsonHandle UBluJsonHandleLibrary::ParseJSONToHandle(const FString& JSONString, bool& bSuccess)
+{
+	TSharedPtr<FJsonObject> Object;
+	TSharedRef<TJsonReader<TCHAR>> Reader = TJsonReaderFactory<TCHAR>::Create(JSONString);
+	bSuccess = FJsonSerializer::Deserialize(Reader, Object) && Object.IsValid();
+
+	return bSuccess ? FBluJsonHandle(Object) : FBluJsonHandle(MakeShared<FJsonObject>());
+}
+
+FBluJsonHandle UBluJsonHandleLibrary::MakeJSONHandle()
+{
+	return FBluJsonHandle(MakeShared<FJsonObject>());
+}
+
+FBluJsonHandle UBluJsonHandleLibrary::ToJSONHandle(UBluJsonObj* JsonObj)
+{
+	return JsonObj ? FBluJsonHandle(JsonObj->GetJsonObj()) : FBluJsonHandle();
+}
+
+UBluJsonObj* UBluJsonHandleLibrary::ToBluJsonObj(const FBluJsonHandle& Handle)
+{
+	UBluJsonObj* JsonObj = NewObject<UBluJsonObj>(GetTransientPackage(), UBluJsonObj::StaticClass());
+	JsonObj->SetJsonObj(Handle.IsValid() ? Handle.Object : MakeShared<FJsonObject>());
+	return JsonObj;
+}
+
+bool UBluJsonHandleLibrary::IsValidHandle(const FBluJsonHandle& Handle)
+{
+	return Handle.IsValid();
+}
+
+FString UBluJsonHandleLibrary::HandleToString(const FBluJsonHandle& Handle)
+{
+	if (!Handle.IsValid())
+	{
+		return FString();
+	}
+
+	return FBluJson::ToString(*Handle.Object);
+}
+
+bool UBluJsonHandleLibrary::HasField(const FBluJsonHandle& Handle, const FString& Index)
+{
+	return Handle.IsValid() && Handle.Object->HasField(Index);
+}
+
+FString UBluJsonHandleLibrary::GetStringValue(const FBluJsonHandle& Handle, const FString& Index)
+{
+	FString Value;
+	if (Handle.IsValid())
+	{
+		Handle.Object->TryGetStringField(Index, Value);
+	}
+	return Value;
+}
+
+float UBluJsonHandleLibrary::GetNumValue(const FBluJsonHandle& Handle, const FString& Index)
+{
+	double Value = 0.0;
+	if (Handle.IsValid())
+	{
+		Handle.Object->TryGetNumberField(Index, Value);
+	}
+	return Value;
+}
+
+bool UBluJsonHandleLibrary::GetBooleanValue(const FBluJsonHandle& Handle, const FString& Index)
+{
+	bool bValue = false;
+	if (Handle.IsValid())
+	{
+		Handle.Object->TryGetBoolField(Index, bValue);
+	}
+	return bValue;
+}
+
+FBluJsonHandle UBluJsonHandleLibrary::GetNestedObject(const FBluJsonHandle& Handle, const FString& Index)
+{
+	const TSharedPtr<FJsonObject>* Nested = nullptr;
+	if (Handle.IsValid() && Handle.Object->TryGetObjectField(Index, Nested))
+	{
+		return FBluJsonHandle(*Nested);
+	}
+	return FBluJsonHandle();
+}
+
+TArray<float> UBluJsonHandleLibrary::GetNumArray(const FBluJsonHandle& Handle, const FString& Index)
+{
+	TArray<float> Temp;
+	if (const TArray<TSharedPtr<FJsonValue>>* Values = FindArray(Handle, Index))
+	{
+		Temp.Reserve(Values->Num());
+		for (const TSharedPtr<FJsonValue>& Val : *Values)
+		{
+			Temp.Add(Val->AsNumber());
+		}
+	}
+	return Temp;
+}
+
+TArray<bool> UBluJsonHandleLibrary::GetBooleanArray(const FBluJsonHandle& Handle, const FString& Index)
+{
+	TArray<bool> Temp;
+	if (const TArray<TSharedPtr<FJsonValue>>* Values = FindArray(Handle, Index))
+	{
+		Temp.Reserve(Values->Num());
+		for (const TSharedPtr<FJsonValue>& Val : *Values)
+		{
+			Temp.Add(Val->AsBool());
+		}
+	}
+	return Temp;
+}
+
+TArray<FString> UBluJsonHandleLibrary::GetStringArray(const FBluJsonHandle& Handle, const FString& Index)
+{
+	TArray<FString> Temp;
+	if (const TArray<TSharedPtr<FJsonValue>>* Values = FindArray(Handle, Index))
+	{
+		Temp.Reserve(Values->Num());
+		for (const TSharedPtr<FJsonValue>& Val : *Values)
+		{
+			Temp.Add(Val->AsString());
+		}
+	}
+	return Temp;
+}
+
+TArray<FBluJsonHandle> UBluJsonHandleLibrary::GetObjectArray(const FBluJsonHandle& Handle, const FString& Index)
+{
+	TArray<FBluJsonHandle> Temp;
+	if (const TArray<TSharedPtr<FJsonValue>>* Values = FindArray(Handle, Index))
+	{
+		Temp.Reserve(Values->Num());
+		for (const TSharedPtr<FJsonValue>& Val : *Values)
+		{
+			const TSharedPtr<FJsonObject>* Nested = nullptr;
+			Temp.Add(Val->TryGetObject(Nested) ? FBluJsonHandle(*Nested) : FBluJsonHandle());
+		}
+	}
+	return Temp;
+}
+
+void UBluJsonHandleLibrary::SetStringValue(const FBluJsonHandle& Handle, const FString& Value, const FString& Index)
+{
+	if (CanSet(Handle))
+	{
+		Handle.Object->SetStringField(Index, Value);
+	}
+}
+
+void UBluJsonHandleLibrary::SetNumValue(const FBluJsonHandle& Handle, const float Value, const FString& Index)
+{
+	if (CanSet(Handle))
+	{
+		Handle.Object->SetNumberField(Index, Value);
+	}
+}
+
+void UBluJsonHandleLibrary::SetBooleanValue(const FBluJsonHandle& Handle, const bool Value, const FString& Index)
+{
+	if (CanSet(Handle))
+	{
+		Handle.Object->SetBoolField(Index, Value);
+	}
+}
+
+void UBluJsonHandleLibrary::SetNestedObject(const FBluJsonHandle& Handle, const FBluJsonHandle& Value, const FString& Index)
+{
+	if (CanSet(Handle) && CanNest(Value))
+	{
+		Handle.Object->SetObjectField(Index, Value.Object);
+	}
+}
+
+void UBluJsonHandleLibrary::SetStringArray(const FBluJsonHandle& Handle, const TArray<FString>& Value, const FString& Index)
+{
+	if (!CanSet(Handle))
+	{
+		return;
+	}
+
+	TArray<TSharedPtr<FJsonValue>> ValueArray;
+	ValueArray.Reserve(Value.Num());
+	for (const FString& Val : Value)
+	{
+		ValueArray.Add(MakeShared<FJsonValueString>(Val));
+	}
+	Handle.Object->SetArrayField(Index, ValueArray);
+}
+
+void UBluJsonHandleLibrary::SetBooleanArray(const FBluJsonHandle& Handle, const TArray<bool>& Value, const FString& Index)
+{
+	if (!CanSet(Handle))
+	{
+		return;
+	}
+
+	TArray<TSharedPtr<FJsonValue>> ValueArray;
+	ValueArray.Reserve(Value.Num());
+	for (bool Val : Value)
+	{
+		ValueArray.Add(MakeShared<FJsonValueBoolean>(Val));
+	}
+	Handle.Object->SetArrayField(Index, ValueArray);
+}
+
+void UBluJsonHandleLibrary::SetNumArray(const FBluJsonHandle& Handle, const TArray<float>& Value, const FString& Index)
+{
+	if (!CanSet(Handle))
+	{
+		return;
+	}
+
+	TArray<TSharedPtr<FJsonValue>> ValueArray;
+	ValueArray.Reserve(Value.Num());
+	for (float Val : Value)
+	{
+		ValueArray.Add(MakeShared<FJsonValueNumber>(Val));
+	}
+	Handle.Object->SetArrayField(Index, ValueArray);
+}
+
+void UBluJsonHandleLibrary::SetObjectArray(const FBluJsonHandle& Handle, const TArray<FBluJsonHandle>& Value, const FString& Index)
+{
+	if (!CanSet(Handle))
+	{
+		return;
+	}
+
+	TArray<TSharedPtr<FJsonValue>> ValueArray;
+	ValueArray.Reserve(Value.Num());
+	for (const FBluJsonHandle& Val : Value)
+	{
+		// Keep the other elements at their indices
+		if (CanNest(Val))
+		{
+			ValueArray.Add(MakeShared<FJsonValueObject>(Val.Object));
+		}
+		else
+		{
+			ValueArray.Add(MakeShared<FJsonValueNull>());
+		}
+	}
+	Handle.Object->SetArrayField(Index, ValueArray);
+}
@@ -1,37 +1,121 @@
 #include "BluJsonObj.h"
 #include "Json.h"
+#include "JsonObjectConverter.h"
+#include "BluMsgPack.h"
 
 UBluJsonObj::UBluJsonObj(const class FObjectInitializer& PCIP)
 : Super(PCIP)
 {
-
+	TapeIndex = FBluJsonTape::RootIndex;
 }
 
 void UBluJsonObj::Init(const FString &StringData)
 {
 	StrData = *StringData;
+	Tape.Reset();
 
 	TSharedRef<TJsonReader<TCHAR>> JsonReader = TJsonReaderFactory<TCHAR>::Create(StringData);
 	DoParseJson(JsonReader);
 }
 
+void UBluJsonObj::InitLazy(const FString &DataString)
+{
+	FTCHARToUTF8 Utf8(*DataString, DataString.Len());
+	InitLazy(Utf8.Get(), Utf8.Length());
+}
+
+void UBluJsonObj::InitLazy(const ANSICHAR* Utf8Data, int32 Length)
+{
+	TSharedPtr<FBluJsonTape> NewTape = MakeShared<FBluJsonTape>();
+	if (!NewTape->Parse(Utf8Data, Length) || NewTape->GetType(FBluJsonTape::RootIndex) != FBluJsonTape::EType::Object)
+	{
+		UE_LOG(LogBlu, Warning, TEXT("JSON STRING FAILED TO PARSE! WILL DEFAULT TO EMPTY OBJECT {}"));
+		Tape.Reset();
+		DoParseJson(TJsonReaderFactory<TCHAR>::Create("{}"));
+		return;
+	}
+
+	SetTape(NewTape, FBluJsonTape::RootIndex);
+}
+
+void UBluJsonObj::SetTape(TSharedPtr<const FBluJsonTape> NewTape, int32 Index)
+{
+	Tape = NewTape;
+	TapeIndex = Index;
+	JsonParsed.Reset();
+}
+
+int32 UBluJsonObj::FindTapeField(const FString &Index) const
+{
+	return Tape->FindField(TapeIndex, Index);
+}
+
+const FBluJsonTape* UBluJsonObj::GetLazyTape(int32& OutIndex) const
+{
+	OutIndex = TapeIndex;
+	return Tape.Get();
+}
+
+void UBluJsonObj::MaterializeTape()
+{
+	if (!Tape.IsValid())
+	{
+		return;
+	}
+
+	JsonParsed = Tape->ToJsonObject(TapeIndex);
+	Tape.Reset();
+}
+
 FString UBluJsonObj::GetStringValue(const FString& Index)
 {
+	if (Tape.IsValid())
+	{
+		const int32 Field = FindTapeField(Index);
+		return Field != FBluJsonTape::InvalidIndex ? Tape->GetString(Field) : FString();
+	}
+
 	return JsonParsed->GetStringField(Index);
 }
 
 bool UBluJsonObj::GetBooleanValue(const FString &Index)
 {
+	if (Tape.IsValid())
+	{
+		const int32 Field = FindTapeField(Index);
+		return Field != FBluJsonTape::InvalidIndex && Tape->GetBool(Field);
+	}
+
 	return JsonParsed->GetBoolField(Index);
 }
 
 float UBluJsonObj::GetNumValue(const FString &Index)
 {
+	if (Tape.IsValid())
+	{
+		const int32 Field = FindTapeField(Index);
+		return Field != FBluJsonTape::InvalidIndex ? Tape->GetNumber(Field) : 0.f;
+	}
+
 	return JsonParsed->GetNumberField(Index);
 }
 
 UBluJsonObj* UBluJsonObj::GetNestedObject(const FString &Index)
 {
+	if (Tape.IsValid())
+	{
+		const int32 Field = FindTapeField(Index);
+		if (Field == FBluJsonTape::InvalidIndex || Tape->GetType(Field) != FBluJsonTape::EType::Object)
+		{
+			return nullptr;
+		}
+
+		// Shares our document, nothing gets parsed or copied
+		UBluJsonObj* LazyObj = NewObject<UBluJsonObj>(GetTransientPackage(), UBluJsonObj::StaticClass());
+		LazyObj->SetTape(Tape, Field);
+		return LazyObj;
+	}
+
 	TSharedPtr<FJsonObject> NewJson = JsonParsed->GetObjectField(Index);
 
 	if (!NewJson.IsValid())
@@ -51,11 +135,28 @@ TArray<float> UBluJsonObj::GetNumArray(const FString &Index)
 {
 	TArray<float> Temp;
 
-	for (TSharedPtr<FJsonValue> Val : JsonParsed->GetArrayField(Index))
+	if (Tape.IsValid())
 	{
+		TArray<int32> Elements;
+		Tape->GetArrayElements(FindTapeField(Index), Elements);
 
-		Temp.Add(Val->AsNumber());
+		Temp.Reserve(Elements.Num());
+		for (int32 Element : Elements)
+		{
+			Temp.Add(Tape->GetNumber(Element));
+		}
 
+		return Temp;
+	}
+
+	const TArray<TSharedPtr<FJsonValue>>* Values = nullptr;
+	if (JsonParsed->TryGetArrayField(Index, Values))
+	{
+		Temp.Reserve(Values->Num());
+		for (const TSharedPtr<FJsonValue>& Val : *Values)
+		{
+			Temp.Add(Val->AsNumber());
+		}
 	}
 
 	return Temp;
@@ -65,11 +166,28 @@ TArray<bool> UBluJsonObj::GetBooleanArray(const FString &Index)
 {
 	TArray<bool> Temp;
 
-	for (TSharedPtr<FJsonValue> Val : JsonParsed->GetArrayField(Index))
+	if (Tape.IsValid())
 	{
+		TArray<int32> Elements;
+		Tape->GetArrayElements(FindTapeField(Index), Elements);
 
-		Temp.Add(Val->AsBool());
+		Temp.Reserve(Elements.Num());
+		for (int32 Element : Elements)
+		{
+			Temp.Add(Tape->GetBool(Element));
+		}
 
+		return Temp;
+	}
+
+	const TArray<TSharedPtr<FJsonValue>>* Values = nullptr;
+	if (JsonParsed->TryGetArrayField(Index, Values))
+	{
+		Temp.Reserve(Values->Num());
+		for (const TSharedPtr<FJsonValue>& Val : *Values)
+		{
+			Temp.Add(Val->AsBool());
+		}
 	}
 
 	return Temp;
@@ -79,11 +197,28 @@ TArray<FString> UBluJsonObj::GetStringArray(const FString &Index)
 {
 	TArray<FString> Temp;
 
-	for (TSharedPtr<FJsonValue> Val : JsonParsed->GetArrayField(Index))
+	if (Tape.IsValid())
 	{
+		TArray<int32> Elements;
+		Tape->GetArrayElements(FindTapeField(Index), Elements);
 
-		Temp.Add(Val->AsString());
+		Temp.Reserve(Elements.Num());
+		for (int32 Element : Elements)
+		{
+			Temp.Add(Tape->GetString(Element));
+		}
 
+		return Temp;
+	}
+
+	const TArray<TSharedPtr<FJsonValue>>* Values = nullptr;
+	if (JsonParsed->TryGetArrayField(Index, Values))
+	{
+		Temp.Reserve(Values->Num());
+		for (const TSharedPtr<FJsonValue>& Val : *Values)
+		{
+			Temp.Add(Val->AsString());
+		}
 	}
 
 	return Temp;
@@ -92,21 +227,25 @@ TArray<FString> UBluJsonObj::GetStringArray(const FString &Index)
 
 void UBluJsonObj::SetStringValue(const FString &Value, const FString &Index)
 {
+	MaterializeTape();
 	JsonParsed->SetStringField(Index, Value);
 }
 
 void UBluJsonObj::SetNumValue(const float Value, const FString &Index)
 {
+	MaterializeTape();
 	JsonParsed->SetNumberField(Index, Value);
 }
 
 void UBluJsonObj::SetBooleanValue(const bool Value, const FString &Index)
 {
+	MaterializeTape();
 	JsonParsed->SetBoolField(Index, Value);
 }
 
 void UBluJsonObj::SetNestedObject(UBluJsonObj *Value, const FString &Index)
 {
+	MaterializeTape();
 	JsonParsed->SetObjectField(Index, Value->GetJsonObj());
 }
 
@@ -114,13 +253,105 @@ void UBluJsonObj::SetJsonObj(TSharedPtr<FJsonObject> NewJson)
 {
 	// Set our new stored JSON object
 	JsonParsed = NewJson;
+	Tape.Reset();
 }
 
 TSharedPtr<FJsonObject> UBluJsonObj::GetJsonObj()
 {
+	MaterializeTape();
 	return JsonParsed;
 }
 
+bool UBluJsonObj::ToStruct(const UScriptStruct* Struct, void* OutStruct)
+{
+	if (!Struct || !OutStruct)
+	{
+		return false;
+	}
+
+	// A lazy object is converted from its own copy, it stays lazy for the getters
+	TSharedPtr<FJsonObject> Source = Tape.IsValid() ? Tape->ToJsonObject(TapeIndex) : JsonParsed;
+	if (!Source.IsValid())
+	{
+		return false;
+	}
+
+	return FJsonObjectConverter::JsonObjectToUStruct(Source.ToSharedRef(), Struct, OutStruct);
+}
+
+bool UBluJsonObj::FromStruct(const UScriptStruct* Struct, const void* Data)
+{
+	if (!Struct || !Data)
+	{
+		return false;
+	}
+
+	TSharedRef<FJsonObject> NewJson = MakeShared<FJsonObject>();
+	if (!FJsonObjectConverter::UStructToJsonObject(Struct, Data, NewJson))
+	{
+		return false;
+	}
+
+	SetJsonObj(NewJson);
+	return true;
+}
+
+DEFINE_FUNCTION(UBluJsonObj::execK2_ToStruct)
+{
+	Stack.MostRecentProperty = nullptr;
+	Stack.StepCompiledIn<FStructProperty>(nullptr);
+	void* StructData = Stack.MostRecentPropertyAddress;
+	FStructProperty* StructProperty = CastField<FStructProperty>(Stack.MostRecentProperty);
+	P_FINISH;
+
+	P_NATIVE_BEGIN;
+	*(bool*)RESULT_PARAM = StructProperty && P_THIS->ToStruct(StructProperty->Struct, StructData);
+	P_NATIVE_END;
+}
+
+DEFINE_FUNCTION(UBluJsonObj::execK2_FromStruct)
+{
+	Stack.MostRecentProperty = nullptr;
+	Stack.StepCompiledIn<FStructProperty>(nullptr);
+	const void* StructData = Stack.MostRecentPropertyAddress;
+	FStructProperty* StructProperty = CastField<FStructProperty>(Stack.MostRecentProperty);
+	P_FINISH;
+
+	P_NATIVE_BEGIN;
+	*(bool*)RESULT_PARAM = StructProperty && P_THIS->FromStruct(StructProperty->Struct, StructData);
+	P_NATIVE_END;
+}
+
+TArray<uint8> UBluJsonObj::ToMessagePack()
+{
+	TArray<uint8> Data;
+	ToMessagePack(Data);
+	return Data;
+}
+
+void UBluJsonObj::ToMessagePack(TArray<uint8>& Out)
+{
+	// Lazy objects are encoded from a copy and stay lazy
+	TSharedPtr<FJsonObject> Source = Tape.IsValid() ? Tape->ToJsonObject(TapeIndex) : JsonParsed;
+	if (Source.IsValid())
+	{
+		FBluMsgPack::Encode(*Source, Out);
+	}
+}
+
+bool UBluJsonObj::FromMessagePack(const TArray<uint8>& Data)
+{
+	TSharedPtr<FJsonObject> NewJson = FBluMsgPack::Decode(Data);
+	if (!NewJson.IsValid())
+	{
+		UE_LOG(LogBlu, Warning, TEXT("MessagePack data doesn't hold a map, leaving the JSON object as it was"));
+		return false;
+	}
+
+	SetJsonObj(NewJson);
+	return true;
+}
+
 void UBluJsonObj::DoParseJson(TSharedRef<TJsonReader<TCHAR>> JsonReader)
 {
 	if (!FJsonSerializer::Deserialize(JsonReader, JsonParsed))
@@ -135,11 +366,12 @@ void UBluJsonObj::DoParseJson(TSharedRef<TJsonReader<TCHAR>> JsonReader)
 // CUSTOM ADDED START
 void UBluJsonObj::SetStringArray(const TArray<FString> &Value, const FString &Index)
 {
+	MaterializeTape();
 	TArray<TSharedPtr<FJsonValue>> ValueArray;
-
-	for (FString Val : Value)
+	ValueArray.Reserve(Value.Num());
+	for (const FString& Val : Value)
 	{
-		ValueArray.Add(MakeShareable(new FJsonValueString(Val)));
+		ValueArray.Add(MakeShared<FJsonValueString>(Val));
 	}
 
 	JsonParsed->SetArrayField(Index, ValueArray);
@@ -147,11 +379,12 @@ void UBluJsonObj::SetStringArray(const TArray<FString> &Value, const FString &In
 
 void UBluJsonObj::SetBooleanArray(const TArray<bool> &Value, const FString &Index)
 {
+	MaterializeTape();
 	TArray<TSharedPtr<FJsonValue>> ValueArray;
-
+	ValueArray.Reserve(Value.Num());
 	for (bool Val : Value)
 	{
-		ValueArray.Add(MakeShareable(new FJsonValueBoolean(Val)));
+		ValueArray.Add(MakeShared<FJsonValueBoolean>(Val));
 	}
 
 	JsonParsed->SetArrayField(Index, ValueArray);
@@ -159,11 +392,12 @@ void UBluJsonObj::SetBooleanArray(const TArray<bool> &Value, const FString &Inde
 
 void UBluJsonObj::SetNumArray(const TArray<float> &Value, const FString &Index)
 {
+	MaterializeTape();
 	TArray<TSharedPtr<FJsonValue>> ValueArray;
-
+	ValueArray.Reserve(Value.Num());
 	for (float Val : Value)
 	{
-		ValueArray.Add(MakeShareable(new FJsonValueNumber(Val)));
+		ValueArray.Add(MakeShared<FJsonValueNumber>(Val));
 	}
 
 	JsonParsed->SetArrayField(Index, ValueArray);
@@ -171,11 +405,12 @@ void UBluJsonObj::SetNumArray(const TArray<float> &Value, const FString &Index)
 
 void UBluJsonObj::SetObjectArray(const TArray<UBluJsonObj*> &Value, const FString &Index)
 {
+	MaterializeTape();
 	TArray<TSharedPtr<FJsonValue>> ValueArray;
-
+	ValueArray.Reserve(Value.Num());
 	for (UBluJsonObj* Val : Value)
 	{
-		ValueArray.Add(MakeShareable(new FJsonValueObject(Val->GetJsonObj())));
+		ValueArray.Add(MakeShared<FJsonValueObject>(Val->GetJsonObj()));
 	}
 
 	JsonParsed->SetArrayField(Index, ValueArray);
@@ -0,0 +1,561 @@
+#include "BluJsonPatch.h"
+#include "BluJsonWriter.h"
+#include "Json.h"
+
+namespace
+{
+	TSharedRef<FJsonObject> MakeOperation(const TCHAR* Op, const FString& Path)
+	{
+		TSharedRef<FJsonObject> Operation = MakeShared<FJsonObject>();
+		Operation->SetStringField(TEXT("op"), Op);
+		Operation->SetStringField(TEXT("path"), Path);
+		return Operation;
+	}
+
+	void AddOperation(TArray<TSharedPtr<FJsonValue>>& Patch, const TCHAR* Op, const FString& Path, const TSharedPtr<FJsonValue>& Value = nullptr)
+	{
+		TSharedRef<FJsonObject> Operation = MakeOperation(Op, Path);
+		if (Value.IsValid())
+		{
+			Operation->SetField(TEXT("value"), Value);
+		}
+		Patch.Add(MakeShared<FJsonValueObject>(Operation));
+	}
+
+	void DiffValues(const TSharedPtr<FJsonValue>& From, const TSharedPtr<FJsonValue>& To, const FString& Path, TArray<TSharedPtr<FJsonValue>>& Patch);
+
+	// FJsonObject keys ignore case, the page's don't
+	struct FCaseSensitiveKeyFuncs : DefaultKeyFuncs<FStringView>
+	{
+		static bool Matches(FStringView A, FStringView B)
+		{
+			return A.Equals(B, ESearchCase::CaseSensitive);
+		}
+
+		static uint32 GetKeyHash(FStringView Key)
+		{
+			return FCrc::MemCrc32(Key.GetData(), Key.Len() * sizeof(TCHAR));
+		}
+	};
+
+	typedef TSet<FStringView, FCaseSensitiveKeyFuncs, TInlineSetAllocator<16>> FExactKeySet;
+
+	void GetExactKeys(const FJsonObject& Object, FExactKeySet& OutKeys)
+	{
+		OutKeys.Reserve(Object.Values.Num());
+		for (const TPair<FString, TSharedPtr<FJsonValue>>& Pair : Object.Values)
+		{
+			OutKeys.Add(Pair.Key);
+		}
+	}
+
+	void DiffObjects(const FJsonObject& From, const FJsonObject& To, const FString& Path, TArray<TSharedPtr<FJsonValue>>& Patch)
+	{
+		// A key whose case changed is a different key to the page, it's removed and added rather than left alone
+		FExactKeySet FromKeys;
+		FExactKeySet ToKeys;
+		GetExactKeys(From, FromKeys);
+		GetExactKeys(To, ToKeys);
+
+		for (const TPair<FString, TSharedPtr<FJsonValue>>& Pair : From.Values)
+		{
+			if (!ToKeys.Contains(Pair.Key))
+			{
+				AddOperation(Patch, TEXT("remove"), Path + TEXT("/") + FBluJsonPatch::EscapePathToken(Pair.Key));
+			}
+		}
+
+		for (const TPair<FString, TSharedPtr<FJsonValue>>& Pair : To.Values)
+		{
+			const FString FieldPath = Path + TEXT("/") + FBluJsonPatch::EscapePathToken(Pair.Key);
+			const TSharedPtr<FJsonValue>* FromValue = FromKeys.Contains(Pair.Key) ? From.Values.Find(Pair.Key) : nullptr;
+			if (FromValue)
+			{
+				DiffValues(*FromValue, Pair.Value, FieldPath, Patch);
+			}
+			else
+			{
+				AddOperation(Patch, TEXT("add"), FieldPath, Pair.Value);
+			}
+		}
+	}
+
+	void DiffArrays(const TArray<TSharedPtr<FJsonValue>>& From, const TArray<TSharedPtr<FJsonValue>>& To, const FString& Path, TArray<TSharedPtr<FJsonValue>>& Patch)
+	{
+		const int32 Common = FMath::Min(From.Num(), To.Num());
+		for (int32 Index = 0; Index < Common; Index++)
+		{
+			DiffValues(From[Index], To[Index], Path + TEXT("/") + FString::FromInt(Index), Patch);
+		}
+
+		for (int32 Index = Common; Index < To.Num(); Index++)
+		{
+			AddOperation(Patch, TEXT("add"), Path + TEXT("/") + FString::FromInt(Index), To[Index]);
+		}
+
+		// From the back, so the indices in front stay put
+		for (int32 Index = From.Num() - 1; Index >= Common; Index--)
+		{
+			AddOperation(Patch, TEXT("remove"), Path + TEXT("/") + FString::FromInt(Index));
+		}
+	}
+
+	void DiffValues(const TSharedPtr<FJsonValue>& From, const TSharedPtr<FJsonValue>& To, const FString& Path, TArray<TSharedPtr<FJsonValue>>& Patch)
+	{
+		// Shared values can't differ, this skips whole subtrees that weren't touched
+		if (From == To)
+		{
+			return;
+		}
+
+		if (From.IsValid() && To.IsValid() && From->Type == To->Type)
+		{
+			if (From->Type == EJson::Object && From->AsObject().IsValid() && To->AsObject().IsValid())
+			{
+				DiffObjects(*From->AsObject(), *To->AsObject(), Path, Patch);
+				return;
+			}
+
+			if (From->Type == EJson::Array)
+			{
+				DiffArrays(From->AsArray(), To->AsArray(), Path, Patch);
+				return;
+			}
+		}
+
+		if (!FBluJsonPatch::Equals(From, To))
+		{
+			AddOperation(Patch, TEXT("replace"), Path, To.IsValid() ? To : MakeShared<FJsonValueNull>());
+		}
+	}
+
+	// FJsonValueArray only hands out its elements as const, but values in a document we're patching are ours to change
+	TArray<TSharedPtr<FJsonValue>>& MutableArray(const FJsonValue& Value)
+	{
+		return const_cast<TArray<TSharedPtr<FJsonValue>>&>(Value.AsArray());
+	}
+
+	// Where the last token of a path lives, either an object field or an array element
+	struct FLocation
+	{
+		FJsonObject* Object = nullptr;
+		TArray<TSharedPtr<FJsonValue>>* Array = nullptr;
+		FString Token;
+	};
+
+	bool ParsePath(const FString& Path, TArray<FString>& OutTokens)
+	{
+		if (Path.IsEmpty())
+		{
+			return true;
+		}
+
+		if (Path[0] != TEXT('/'))
+		{
+			return false;
+		}
+
+		Path.RightChop(1).ParseIntoArray(OutTokens, TEXT("/"), false);
+		if (OutTokens.Num() == 0)
+		{
+			// "/" is the field with an empty key
+			OutTokens.Add(FString());
+		}
+		for (FString& Token : OutTokens)
+		{
+			Token.ReplaceInline(TEXT("~1"), TEXT("/"), ESearchCase::CaseSensitive);
+			Token.ReplaceInline(TEXT("~0"), TEXT("~"), ESearchCase::CaseSensitive);
+		}
+		return true;
+	}
+
+	// Array index from a path token, "-" is one past the end. INDEX_NONE if it isn't one
+	int32 ParseIndex(const FString& Token, int32 Num)
+	{
+		if (Token == TEXT("-"))
+		{
+			return Num;
+		}
+
+		if (Token.IsEmpty() || (Token.Len() > 1 && Token[0] == TEXT('0')))
+		{
+			return INDEX_NONE;
+		}
+
+		for (TCHAR Char : Token)
+		{
+			if (!FChar::IsDigit(Char))
+			{
+				return INDEX_NONE;
+			}
+		}
+		return FCString::Atoi(*Token);
+	}
+
+	TSharedPtr<FJsonValue>* FindChild(const FLocation& Location, const FString& Token)
+	{
+		if (Location.Object)
+		{
+			return Location.Object->Values.Find(Token);
+		}
+
+		const int32 Index = ParseIndex(Token, Location.Array->Num());
+		return Location.Array->IsValidIndex(Index) ? &(*Location.Array)[Index] : nullptr;
+	}
+
+	bool Resolve(FJsonObject& Root, const FString& Path, FLocation& OutLocation)
+	{
+		TArray<FString> Tokens;
+		if (!ParsePath(Path, Tokens) || Tokens.Num() == 0)
+		{
+			return false;
+		}
+
+		OutLocation.Object = &Root;
+		OutLocation.Array = nullptr;
+
+		for (int32 TokenIndex = 0; TokenIndex < Tokens.Num() - 1; TokenIndex++)
+		{
+			TSharedPtr<FJsonValue>* Child = FindChild(OutLocation, Tokens[TokenIndex]);
+			if (!Child || !Child->IsValid())
+			{
+				return false;
+			}
+
+			if ((*Child)->Type == EJson::Object && (*Child)->AsObject().IsValid())
+			{
+				OutLocation.Object = (*Child)->AsObject().Get();
+				OutLocation.Array = nullptr;
+			}
+			else if ((*Child)->Type == EJson::Array)
+			{
+				OutLocation.Object = nullptr;
+				OutLocation.Array = &MutableArray(**Child);
+			}
+			else
+			{
+				return false;
+			}
+		}
+
+		OutLocation.Token = Tokens.Last();
+		return true;
+	}
+
+	bool AddValue(const FLocation& Location, const TSharedPtr<FJsonValue>& Value)
+	{
+		if (Location.Object)
+		{
+			Location.Object->Values.Add(Location.Token, Value);
+			return true;
+		}
+
+		const int32 Index = ParseIndex(Location.Token, Location.Array->Num());
+		if (Index == INDEX_NONE || Index > Location.Array->Num())
+		{
+			return false;
+		}
+		Location.Array->Insert(Value, Index);
+		return true;
+	}
+
+	bool RemoveValue(const FLocation& Location, TSharedPtr<FJsonValue>* OutRemoved = nullptr)
+	{
+		if (Location.Object)
+		{
+			return OutRemoved ? Location.Object->Values.RemoveAndCopyValue(Location.Token, *OutRemoved) : Location.Object->Values.Remove(Location.Token) > 0;
+		}
+
+		const int32 Index = ParseIndex(Location.Token, Location.Array->Num());
+		if (!Location.Array->IsValidIndex(Index))
+		{
+			return false;
+		}
+
+		if (OutRemoved)
+		{
+			*OutRemoved = (*Location.Array)[Index];
+		}
+		Location.Array->RemoveAt(Index);
+		return true;
+	}
+
+	// Value at a path, the root has no FJsonValue of its own so it can't be taken
+	TSharedPtr<FJsonValue> GetValue(FJsonObject& Root, const FString& Path)
+	{
+		FLocation Location;
+		if (!Resolve(Root, Path, Location))
+		{
+			return nullptr;
+		}
+
+		TSharedPtr<FJsonValue>* Value = FindChild(Location, Location.Token);
+		return Value ? *Value : nullptr;
+	}
+}
+
+TArray<TSharedPtr<FJsonValue>> FBluJsonPatch::Diff(const FJsonObject& From, const FJsonObject& To)
+{
+	TArray<TSharedPtr<FJsonValue>> Patch;
+	DiffObjects(From, To, FString(), Patch);
+	return Patch;
+}
+
+bool FBluJsonPatch::Apply(FJsonObject& Target, const TArray<TSharedPtr<FJsonValue>>& Patch, FString* OutError)
+{
+	auto Fail = [OutError](int32 OperationIndex, const FString& Reason)
+	{
+		if (OutError)
+		{
+			*OutError = FString::Printf(TEXT("Operation %d: %s"), OperationIndex, *Reason);
+		}
+		return false;
+	};
+
+	for (int32 OperationIndex = 0; OperationIndex < Patch.Num(); OperationIndex++)
+	{
+		const TSharedPtr<FJsonObject>* Operation = nullptr;
+		FString Op;
+		FString Path;
+		if (!Patch[OperationIndex].IsValid() || !Patch[OperationIndex]->TryGetObject(Operation) || !(*Operation)->TryGetStringField(TEXT("op"), Op) || !(*Operation)->TryGetStringField(TEXT("path"), Path))
+		{
+			return Fail(OperationIndex, TEXT("needs an op and a path"));
+		}
+
+		TSharedPtr<FJsonValue> Value = (*Operation)->TryGetField(TEXT("value"));
+
+		// Replacing the whole document
+		if (Path.IsEmpty() && (Op == TEXT("add") || Op == TEXT("replace")))
+		{
+			if (!Value.IsValid() || Value->Type != EJson::Object || !Value->AsObject().IsValid())
+			{
+				return Fail(OperationIndex, TEXT("the root can only be replaced with an object"));
+			}
+			Target.Values = CloneObject(*Value->AsObject())->Values;
+			continue;
+		}
+
+		if (Op == TEXT("test"))
+		{
+			if (!Equals(GetValue(Target, Path), Value))
+			{
+				return Fail(OperationIndex, FString::Printf(TEXT("test failed at '%s'"), *Path));
+			}
+			continue;
+		}
+
+		// Move and copy take their value from another path
+		if (Op == TEXT("move") || Op == TEXT("copy"))
+		{
+			FString From;
+			if (!(*Operation)->TryGetStringField(TEXT("from"), From))
+			{
+				return Fail(OperationIndex, TEXT("needs a from path"));
+			}
+
+			if (Op == TEXT("move"))
+			{
+				if (Path.StartsWith(From + TEXT("/"), ESearchCase::CaseSensitive))
+				{
+					return Fail(OperationIndex, TEXT("can't move a value into itself"));
+				}
+
+				FLocation FromLocation;
+				if (!Resolve(Target, From, FromLocation) || !RemoveValue(FromLocation, &Value))
+				{
+					return Fail(OperationIndex, FString::Printf(TEXT("nothing at '%s'"), *From));
+				}
+			}
+			else
+			{
+				Value = Clone(GetValue(Target, From));
+				if (!Value.IsValid())
+				{
+					return Fail(OperationIndex, FString::Printf(TEXT("nothing at '%s'"), *From));
+				}
+			}
+
+			FLocation Location;
+			if (!Resolve(Target, Path, Location) || !AddValue(Location, Value))
+			{
+				return Fail(OperationIndex, FString::Printf(TEXT("can't add at '%s'"), *Path));
+			}
+			continue;
+		}
+
+		FLocation Location;
+		if (!Resolve(Target, Path, Location))
+		{
+			return Fail(OperationIndex, FString::Printf(TEXT("'%s' doesn't exist"), *Path));
+		}
+
+		if (Op == TEXT("remove"))
+		{
+			if (!RemoveValue(Location))
+			{
+				return Fail(OperationIndex, FString::Printf(TEXT("nothing at '%s'"), *Path));
+			}
+			continue;
+		}
+
+		if (!Value.IsValid())
+		{
+			return Fail(OperationIndex, TEXT("needs a value"));
+		}
+
+		if (Op == TEXT("add"))
+		{
+			if (!AddValue(Location, Clone(Value)))
+			{
+				return Fail(OperationIndex, FString::Printf(TEXT("can't add at '%s'"), *Path));
+			}
+		}
+		else if (Op == TEXT("replace"))
+		{
+			TSharedPtr<FJsonValue>* Existing = FindChild(Location, Location.Token);
+			if (!Existing)
+			{
+				return Fail(OperationIndex, FString::Printf(TEXT("nothing at '%s'"), *Path));
+			}
+			*Existing = Clone(Value);
+		}
+		else
+		{
+			return Fail(OperationIndex, FString::Printf(TEXT("unknown op '%s'"), *Op));
+		}
+	}
+
+	return true;
+}
+
+FString FBluJsonPatch::ToString(const TArray<TSharedPtr<FJsonValue>>& Patch)
+{
+	return FBluJson::ToString(Patch);
+}
+
+TSharedPtr<FJsonValue> FBluJsonPatch::Clone(const TSharedPtr<FJsonValue>& Value)
+{
+	if (!Value.IsValid())
+	{
+		return Value;
+	}
+
+	if (Value->Type == EJson::Object && Value->AsObject().IsValid())
+	{
+		return MakeShared<FJsonValueObject>(CloneObject(*Value->AsObject()));
+	}
+
+	if (Value->Type == EJson::Array)
+	{
+		const TArray<TSharedPtr<FJsonValue>>& Elements = Value->AsArray();
+
+		TArray<TSharedPtr<FJsonValue>> Copy;
+		Copy.Reserve(Elements.Num());
+		for (const TSharedPtr<FJsonValue>& Element : Elements)
+		{
+			Copy.Add(Clone(Element));
+		}
+		return MakeShared<FJsonValueArray>(Copy);
+	}
+
+	return Value;
+}
+
+TSharedRef<FJsonObject> FBluJsonPatch::CloneObject(const FJsonObject& Object)
+{
+	TSharedRef<FJsonObject> Copy = MakeShared<FJsonObject>();
+	Copy->Values.Reserve(Object.Values.Num());
+	for (const TPair<FString, TSharedPtr<FJsonValue>>& Pair : Object.Values)
+	{
+		Copy->Values.Add(Pair.Key, Clone(Pair.Value));
+	}
+	return Copy;
+}
+
+bool FBluJsonPatch::Equals(const TSharedPtr<FJsonValue>& A, const TSharedPtr<FJsonValue>& B)
+{
+	if (A == B)
+	{
+		return true;
+	}
+
+	// A missing value and JSON null are the same thing once it's been sent
+	const EJson TypeA = A.IsValid() ? A->Type : EJson::Null;
+	const EJson TypeB = B.IsValid() ? B->Type : EJson::Null;
+	if (TypeA != TypeB)
+	{
+		return false;
+	}
+
+	switch (TypeA)
+	{
+	case EJson::None:
+	case EJson::Null:
+		return true;
+	case EJson::Boolean:
+		return A->AsBool() == B->AsBool();
+	case EJson::Number:
+		return A->AsNumber() == B->AsNumber();
+	case EJson::String:
+		return A->AsString().Equals(B->AsString(), ESearchCase::CaseSensitive);
+	case EJson::Array:
+	{
+		const TArray<TSharedPtr<FJsonValue>>& ElementsA = A->AsArray();
+		const TArray<TSharedPtr<FJsonValue>>& ElementsB = B->AsArray();
+		if (ElementsA.Num() != ElementsB.Num())
+		{
+			return false;
+		}
+
+		for (int32 Index = 0; Index < ElementsA.Num(); Index++)
+		{
+			if (!Equals(ElementsA[Index], ElementsB[Index]))
+			{
+				return false;
+			}
+		}
+		return true;
+	}
+	case EJson::Object:
+	{
+		const TSharedPtr<FJsonObject>& ObjectA = A->AsObject();
+		const TSharedPtr<FJsonObject>& ObjectB = B->AsObject();
+		if (!ObjectA.IsValid() || !ObjectB.IsValid())
+		{
+			return ObjectA.IsValid() == ObjectB.IsValid();
+		}
+
+		if (ObjectA->Values.Num() != ObjectB->Values.Num())
+		{
+			return false;
+		}
+
+		// Same rule as DiffObjects, keys differing only in case aren't the same key
+		FExactKeySet KeysB;
+		GetExactKeys(*ObjectB, KeysB);
+
+		for (const TPair<FString, TSharedPtr<FJsonValue>>& Pair : ObjectA->Values)
+		{
+			const TSharedPtr<FJsonValue>* Other = KeysB.Contains(Pair.Key) ? ObjectB->Values.Find(Pair.Key) : nullptr;
+			if (!Other || !Equals(Pair.Value, *Other))
+			{
+				return false;
+			}
+		}
+		return true;
+	}
+	}
+
+	return false;
+}
+
+FString FBluJsonPatch::EscapePathToken(const FString& Key)
+{
+	int32 Unused;
+	if (!Key.FindChar(TEXT('~'), Unused) && !Key.FindChar(TEXT('/'), Unused))
+	{
+		return Key;
+	}
+
+	return Key.Replace(TEXT("~"), TEXT("~0")).Replace(TEXT("/"), TEXT("~1"));
+}
@@ -0,0 +1,557 @@
+#include "BluJsonPath.h"
+#include "BluJsonObj.h"
+#include "BluJsonTape.h"
+#include "IBlu.h"
+#include "Json.h"
+#include "JsonObjectConverter.h"
+
+bool FBluJsonPath::FSegment::Matches(const FSegment& Other) const
+{
+	if (IsKey() != Other.IsKey())
+	{
+		return false;
+	}
+
+	// Same comparison FJsonObject uses for its keys
+	return IsKey() ? Key == Other.Key : ArrayIndex == Other.ArrayIndex;
+}
+
+FBluJsonPath FBluJsonPath::Compile(const FString& InPath, FString* OutError)
+{
+	FBluJsonPath Result;
+	Result.Path = InPath;
+
+	auto Fail = [&Result, OutError](const FString& Error)
+	{
+		if (OutError)
+		{
+			*OutError = Error;
+		}
+		Result.Segments.Reset();
+		return Result;
+	};
+
+	const int32 Length = InPath.Len();
+	int32 Pos = 0;
+
+	while (Pos < Length)
+	{
+		FSegment Segment;
+
+		if (InPath[Pos] == TEXT('['))
+		{
+			int32 Close = InPath.Find(TEXT("]"), ESearchCase::CaseSensitive, ESearchDir::FromStart, Pos);
+			if (Close == INDEX_NONE)
+			{
+				return Fail(FString::Printf(TEXT("Missing ] after position %d"), Pos));
+			}
+
+			const FString IndexString = InPath.Mid(Pos + 1, Close - Pos - 1);
+			if (IndexString.IsEmpty() || !IndexString.IsNumeric() || IndexString.Contains(TEXT(".")) || IndexString.StartsWith(TEXT("-")))
+			{
+				return Fail(FString::Printf(TEXT("'%s' isn't an array index"), *IndexString));
+			}
+
+			Segment.ArrayIndex = FCString::Atoi(*IndexString);
+			Pos = Close + 1;
+		}
+		else
+		{
+			int32 End = Pos;
+			while (End < Length && InPath[End] != TEXT('.') && InPath[End] != TEXT('['))
+			{
+				End++;
+			}
+
+			if (End == Pos)
+			{
+				return Fail(FString::Printf(TEXT("Empty key at position %d"), Pos));
+			}
+
+			Segment.Key = InPath.Mid(Pos, End - Pos);
+			Segment.KeyHash = GetTypeHash(Segment.Key);
+
+			FTCHARToUTF8 Utf8Key(*Segment.Key, Segment.Key.Len());
+			Segment.Utf8Key.Append(Utf8Key.Get(), Utf8Key.Length());
+
+			Pos = End;
+		}
+
+		Result.Segments.Add(MoveTemp(Segment));
+
+		// A dot has to be followed by another key
+		if (Pos < Length && InPath[Pos] == TEXT('.'))
+		{
+			Pos++;
+			if (Pos == Length || InPath[Pos] == TEXT('['))
+			{
+				return Fail(FString::Printf(TEXT("Expected a key after the dot at position %d"), Pos - 1));
+			}
+		}
+	}
+
+	if (Result.Segments.Num() == 0)
+	{
+		return Fail(TEXT("Path is empty"));
+	}
+
+	return Result;
+}
+
+const TSharedPtr<FJsonValue>* FBluJsonPath::Step(const FJsonObject& Object, const FSegment& Segment)
+{
+	return Segment.IsKey() ? Object.Values.FindByHash(Segment.KeyHash, Segment.Key) : nullptr;
+}
+
+const TSharedPtr<FJsonValue>* FBluJsonPath::Step(const TSharedPtr<FJsonValue>& Value, const FSegment& Segment)
+{
+	if (!Value.IsValid())
+	{
+		return nullptr;
+	}
+
+	if (Segment.IsKey())
+	{
+		const TSharedPtr<FJsonObject>* Object = nullptr;
+		return Value->TryGetObject(Object) ? Step(**Object, Segment) : nullptr;
+	}
+
+	const TArray<TSharedPtr<FJsonValue>>* Array = nullptr;
+	if (!Value->TryGetArray(Array) || !Array->IsValidIndex(Segment.ArrayIndex))
+	{
+		return nullptr;
+	}
+	return &(*Array)[Segment.ArrayIndex];
+}
+
+int32 FBluJsonPath::Step(const FBluJsonTape& Tape, int32 Index, const FSegment& Segment)
+{
+	if (Segment.IsKey())
+	{
+		return Tape.FindFieldUtf8(Index, Segment.Utf8Key.GetData(), Segment.Utf8Key.Num());
+	}
+	return Tape.GetArrayElement(Index, Segment.ArrayIndex);
+}
+
+const TSharedPtr<FJsonValue>* FBluJsonPath::Find(const FJsonObject& Root) const
+{
+	if (!IsValid())
+	{
+		return nullptr;
+	}
+
+	const TSharedPtr<FJsonValue>* Value = Step(Root, Segments[0]);
+	for (int32 Index = 1; Value && Index < Segments.Num(); Index++)
+	{
+		Value = Step(*Value, Segments[Index]);
+	}
+	return Value;
+}
+
+int32 FBluJsonPath::Find(const FBluJsonTape& Tape, int32 RootIndex) const
+{
+	int32 Index = IsValid() ? RootIndex : FBluJsonTape::InvalidIndex;
+	for (const FSegment& Segment : Segments)
+	{
+		if (Index == FBluJsonTape::InvalidIndex)
+		{
+			break;
+		}
+		Index = Step(Tape, Index, Segment);
+	}
+	return Index;
+}
+
+void FBluJsonPath::PostSerialize(const FArchive& Ar)
+{
+	if (Ar.IsLoading())
+	{
+		Segments = Compile(Path).Segments;
+	}
+}
+
+bool FBluJsonStructPaths::Compile(const UScriptStruct* InStruct, const TMap<FName, FString>& FieldPaths, FString* OutError)
+{
+	Struct = InStruct;
+	Nodes.Reset();
+	Nodes.AddDefaulted();
+
+	for (const TPair<FName, FString>& FieldPath : FieldPaths)
+	{
+		FProperty* Property = InStruct->FindPropertyByName(FieldPath.Key);
+		if (!Property)
+		{
+			if (OutError)
+			{
+				*OutError = FString::Printf(TEXT("%s has no field %s"), *InStruct->GetName(), *FieldPath.Key.ToString());
+			}
+			Nodes.Reset();
+			return false;
+		}
+
+		FString PathError;
+		const FBluJsonPath Path = FBluJsonPath::Compile(FieldPath.Value, &PathError);
+		if (!Path.IsValid() || !Path.Segments[0].IsKey())
+		{
+			if (OutError)
+			{
+				*OutError = FString::Printf(TEXT("Bad path for %s: %s"), *FieldPath.Key.ToString(), PathError.IsEmpty() ? TEXT("the root is an object") : *PathError);
+			}
+			Nodes.Reset();
+			return false;
+		}
+
+		// Share the nodes of any path that starts the same way
+		int32 NodeIndex = 0;
+		for (const FBluJsonPath::FSegment& Segment : Path.Segments)
+		{
+			int32 ChildIndex = INDEX_NONE;
+			for (int32 Child : Nodes[NodeIndex].Children)
+			{
+				if (Nodes[Child].Segment.Matches(Segment))
+				{
+					ChildIndex = Child;
+					break;
+				}
+			}
+
+			if (ChildIndex == INDEX_NONE)
+			{
+				ChildIndex = Nodes.Num();
+				Nodes.AddDefaulted_GetRef().Segment = Segment;
+				Nodes[NodeIndex].Children.Add(ChildIndex);
+			}
+
+			NodeIndex = ChildIndex;
+		}
+
+		Nodes[NodeIndex].Properties.Add(Property);
+	}
+
+	return true;
+}
+
+int32 FBluJsonStructPaths::Extract(const FJsonObject& Root, void* OutStruct) const
+{
+	int32 Filled = 0;
+	if (Nodes.Num() == 0)
+	{
+		return Filled;
+	}
+
+	for (int32 Child : Nodes[0].Children)
+	{
+		const FNode& Node = Nodes[Child];
+		if (const TSharedPtr<FJsonValue>* Value = FBluJsonPath::Step(Root, Node.Segment))
+		{
+			ExtractNode(Node, *Value, OutStruct, Filled);
+		}
+	}
+
+	return Filled;
+}
+
+void FBluJsonStructPaths::ExtractNode(const FNode& Node, const TSharedPtr<FJsonValue>& Value, void* OutStruct, int32& Filled) const
+{
+	for (FProperty* Property : Node.Properties)
+	{
+		if (FJsonObjectConverter::JsonValueToUProperty(Value, Property, Property->ContainerPtrToValuePtr<void>(OutStruct), 0, 0))
+		{
+			Filled++;
+		}
+	}
+
+	for (int32 Child : Node.Children)
+	{
+		const FNode& ChildNode = Nodes[Child];
+		if (const TSharedPtr<FJsonValue>* ChildValue = FBluJsonPath::Step(Value, ChildNode.Segment))
+		{
+			ExtractNode(ChildNode, *ChildValue, OutStruct, Filled);
+		}
+	}
+}
+
+int32 FBluJsonStructPaths::Extract(const FBluJsonTape& Tape, int32 RootIndex, void* OutStruct) const
+{
+	int32 Filled = 0;
+	if (Nodes.Num() == 0)
+	{
+		return Filled;
+	}
+
+	for (int32 Child : Nodes[0].Children)
+	{
+		const FNode& Node = Nodes[Child];
+		const int32 Index = FBluJsonPath::Step(Tape, RootIndex, Node.Segment);
+		if (Index != FBluJsonTape::InvalidIndex)
+		{
+			ExtractNode(Node, Tape, Index, OutStruct, Filled);
+		}
+	}
+
+	return Filled;
+}
+
+void FBluJsonStructPaths::ExtractNode(const FNode& Node, const FBluJsonTape& Tape, int32 Index, void* OutStruct, int32& Filled) const
+{
+	if (Node.Properties.Num() > 0)
+	{
+		// Only what a field takes gets built, usually a single value
+		const TSharedPtr<FJsonValue> Value = Tape.ToJsonValue(Index);
+		for (FProperty* Property : Node.Properties)
+		{
+			if (FJsonObjectConverter::JsonValueToUProperty(Value, Property, Property->ContainerPtrToValuePtr<void>(OutStruct), 0, 0))
+			{
+				Filled++;
+			}
+		}
+	}
+
+	for (int32 Child : Node.Children)
+	{
+		const FNode& ChildNode = Nodes[Child];
+		const int32 ChildIndex = FBluJsonPath::Step(Tape, Index, ChildNode.Segment);
+		if (ChildIndex != FBluJsonTape::InvalidIndex)
+		{
+			ExtractNode(ChildNode, Tape, ChildIndex, OutStruct, Filled);
+		}
+	}
+}
+
+namespace
+{
+	// Where a path ended up, in whichever backend the object is using
+	struct FPathHit
+	{
+		const TSharedPtr<FJsonValue>* Value = nullptr;
+		const FBluJsonTape* Tape = nullptr;
+		int32 TapeIndex = FBluJsonTape::InvalidIndex;
+
+		bool IsFound() const
+		{
+			return Value != nullptr || TapeIndex != FBluJsonTape::InvalidIndex;
+		}
+	};
+
+	FPathHit FindPath(UBluJsonObj* JsonObj, const FBluJsonPath& Path)
+	{
+		FPathHit Hit;
+		if (!JsonObj)
+		{
+			return Hit;
+		}
+
+		int32 RootIndex;
+		if (const FBluJsonTape* Tape = JsonObj->GetLazyTape(RootIndex))
+		{
+			Hit.Tape = Tape;
+			Hit.TapeIndex = Path.Find(*Tape, RootIndex);
+			return Hit;
+		}
+
+		const TSharedPtr<FJsonObject> Root = JsonObj->GetJsonObj();
+		if (Root.IsValid())
+		{
+			Hit.Value = Path.Find(*Root);
+		}
+		return Hit;
+	}
+
+	bool ReadNumber(const FPathHit& Hit, float& OutValue)
+	{
+		if (Hit.Tape)
+		{
+			if (Hit.TapeIndex == FBluJsonTape::InvalidIndex)
+			{
+				return false;
+			}
+
+			// Same values TryGetNumber takes: numbers, booleans and strings holding a number
+			switch (Hit.Tape->GetType(Hit.TapeIndex))
+			{
+			case FBluJsonTape::EType::Number:
+			case FBluJsonTape::EType::True:
+			case FBluJsonTape::EType::False:
+				OutValue = Hit.Tape->GetNumber(Hit.TapeIndex);
+				return true;
+			case FBluJsonTape::EType::String:
+			{
+				double Number = 0.0;
+				if (!LexTryParseString(Number, *Hit.Tape->GetString(Hit.TapeIndex)))
+				{
+					return false;
+				}
+				OutValue = Number;
+				return true;
+			}
+			default:
+				return false;
+			}
+		}
+
+		double Number = 0.0;
+		if (Hit.Value && (*Hit.Value)->TryGetNumber(Number))
+		{
+			OutValue = Number;
+			return true;
+		}
+		return false;
+	}
+
+	bool ReadString(const FPathHit& Hit, FString& OutValue)
+	{
+		if (Hit.Tape)
+		{
+			if (Hit.TapeIndex == FBluJsonTape::InvalidIndex)
+			{
+				return false;
+			}
+
+			// Same values TryGetString takes, objects, arrays and null aren't strings
+			switch (Hit.Tape->GetType(Hit.TapeIndex))
+			{
+			case FBluJsonTape::EType::String:
+			case FBluJsonTape::EType::Number:
+			case FBluJsonTape::EType::True:
+			case FBluJsonTape::EType::False:
+				OutValue = Hit.Tape->GetString(Hit.TapeIndex);
+				return true;
+			default:
+				return false;
+			}
+		}
+
+		return Hit.Value && (*Hit.Value)->TryGetString(OutValue);
+	}
+}
+
+FBluJsonPath UBluJsonPathLibrary::CompileJsonPath(const FString& Path, bool& bSuccess)
+{
+	FString Error;
+	FBluJsonPath Compiled = FBluJsonPath::Compile(Path, &Error);
+
+	bSuccess = Compiled.IsValid();
+	if (!bSuccess)
+	{
+		UE_LOG(LogBlu, Warning, TEXT("Can't compile JSON path '%s': %s"), *Path, *Error);
+	}
+	return Compiled;
+}
+
+bool UBluJsonPathLibrary::GetNumberAtPath(UBluJsonObj* JsonObj, const FBluJsonPath& Path, float& Value)
+{
+	Value = 0.f;
+	return ReadNumber(FindPath(JsonObj, Path), Value);
+}
+
+bool UBluJsonPathLibrary::GetStringAtPath(UBluJsonObj* JsonObj, const FBluJsonPath& Path, FString& Value)
+{
+	Value.Reset();
+	return ReadString(FindPath(JsonObj, Path), Value);
+}
+
+bool UBluJsonPathLibrary::GetBooleanAtPath(UBluJsonObj* JsonObj, const FBluJsonPath& Path, bool& Value)
+{
+	Value = false;
+	const FPathHit Hit = FindPath(JsonObj, Path);
+
+	if (Hit.Tape)
+	{
+		if (Hit.TapeIndex == FBluJsonTape::InvalidIndex)
+		{
+			return false;
+		}
+
+		const FBluJsonTape::EType Type = Hit.Tape->GetType(Hit.TapeIndex);
+		Value = Type == FBluJsonTape::EType::True;
+		return Type == FBluJsonTape::EType::True || Type == FBluJsonTape::EType::False;
+	}
+
+	return Hit.Value && (*Hit.Value)->TryGetBool(Value);
+}
+
+bool UBluJsonPathLibrary::GetNumArrayAtPath(UBluJsonObj* JsonObj, const FBluJsonPath& Path, TArray<float>& Value)
+{
+	Value.Reset();
+	const FPathHit Hit = FindPath(JsonObj, Path);
+
+	if (Hit.Tape)
+	{
+		if (Hit.TapeIndex == FBluJsonTape::InvalidIndex || Hit.Tape->GetType(Hit.TapeIndex) != FBluJsonTape::EType::Array)
+		{
+			return false;
+		}
+
+		Value.Reserve(Hit.Tape->GetCount(Hit.TapeIndex));
+		for (int32 Element = Hit.Tape->GetFirstChild(Hit.TapeIndex); Element != FBluJsonTape::InvalidIndex; Element = Hit.Tape->GetNextSibling(Element))
+		{
+			Value.Add(Hit.Tape->GetNumber(Element));
+		}
+		return true;
+	}
+
+	const TArray<TSharedPtr<FJsonValue>>* Array = nullptr;
+	if (!Hit.Value || !(*Hit.Value)->TryGetArray(Array))
+	{
+		return false;
+	}
+
+	Value.Reserve(Array->Num());
+	for (const TSharedPtr<FJsonValue>& Element : *Array)
+	{
+		double Number = 0.0;
+		Element->TryGetNumber(Number);
+		Value.Add(Number);
+	}
+	return true;
+}
+
+bool UBluJsonPathLibrary::GetObjectAtPath(UBluJsonObj* JsonObj, const FBluJsonPath& Path, FBluJsonHandle& Value)
+{
+	Value = FBluJsonHandle();
+	const FPathHit Hit = FindPath(JsonObj, Path);
+
+	if (Hit.Tape)
+	{
+		// Handles need a built object, only this part of the document gets built
+		if (Hit.TapeIndex == FBluJsonTape::InvalidIndex || Hit.Tape->GetType(Hit.TapeIndex) != FBluJsonTape::EType::Object)
+		{
+			return false;
+		}
+		Value = FBluJsonHandle(Hit.Tape->ToJsonObject(Hit.TapeIndex));
+		return true;
+	}
+
+	const TSharedPtr<FJsonObject>* Object = nullptr;
+	if (!Hit.Value || !(*Hit.Value)->TryGetObject(Object))
+	{
+		return false;
+	}
+
+	Value = FBluJsonHandle(*Object);
+	return true;
+}
+
+TArray<float> UBluJsonPathLibrary::GetNumbersAtPaths(UBluJsonObj* JsonObj, const TArray<FBluJsonPath>& Paths)
+{
+	TArray<float> Values;
+	Values.SetNumZeroed(Paths.Num());
+
+	for (int32 Index = 0; Index < Paths.Num(); Index++)
+	{
+		ReadNumber(FindPath(JsonObj, Paths[Index]), Values[Index]);
+	}
+	return Values;
+}
+
+TArray<FString> UBluJsonPathLibrary::GetStringsAtPaths(UBluJsonObj* JsonObj, const TArray<FBluJsonPath>& Paths)
+{
+	TArray<FString> Values;
+	Values.SetNum(Paths.Num());
+
+	for (int32 Index = 0; Index < Paths.Num(); Index++)
+	{
+		ReadString(FindPath(JsonObj, Paths[Index]), Values[Index]);
+	}
+	return Values;
+}
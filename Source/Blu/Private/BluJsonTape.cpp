@@ -0,0 +1,655 @@
+#include "BluJsonTape.h"
+#include "IBlu.h"
+#include "Json.h"
+
+namespace
+{
+	constexpr uint64 OnesMask = 0x0101010101010101ull;
+	constexpr uint64 HighMask = 0x8080808080808080ull;
+
+	// Does any of the 8 bytes in Word equal Byte?
+	FORCEINLINE bool HasByte(uint64 Word, uint8 Byte)
+	{
+		const uint64 Matched = Word ^ (OnesMask * Byte);
+		return ((Matched - OnesMask) & ~Matched & HighMask) != 0;
+	}
+
+	int32 HexValue(uint8 Char)
+	{
+		if (Char >= '0' && Char <= '9')
+		{
+			return Char - '0';
+		}
+		if (Char >= 'a' && Char <= 'f')
+		{
+			return Char - 'a' + 10;
+		}
+		if (Char >= 'A' && Char <= 'F')
+		{
+			return Char - 'A' + 10;
+		}
+		return -1;
+	}
+
+	// False unless all four are hex digits
+	bool ReadHex4(const uint8* Data, uint32& OutValue)
+	{
+		OutValue = 0;
+		for (int32 Index = 0; Index < 4; Index++)
+		{
+			const int32 Digit = HexValue(Data[Index]);
+			if (Digit < 0)
+			{
+				return false;
+			}
+			OutValue = (OutValue << 4) | uint32(Digit);
+		}
+		return true;
+	}
+
+	FORCEINLINE bool IsDigit(uint8 Char)
+	{
+		return Char >= '0' && Char <= '9';
+	}
+
+	// FJsonObject keys only fold ASCII case, so we do the same
+	FORCEINLINE uint8 ToLowerAscii(uint8 Char)
+	{
+		return Char >= 'A' && Char <= 'Z' ? Char + ('a' - 'A') : Char;
+	}
+
+	void AppendUtf8(TArray<ANSICHAR>& Out, uint32 CodePoint)
+	{
+		if (CodePoint < 0x80)
+		{
+			Out.Add(ANSICHAR(CodePoint));
+		}
+		else if (CodePoint < 0x800)
+		{
+			Out.Add(ANSICHAR(0xC0 | (CodePoint >> 6)));
+			Out.Add(ANSICHAR(0x80 | (CodePoint & 0x3F)));
+		}
+		else if (CodePoint < 0x10000)
+		{
+			Out.Add(ANSICHAR(0xE0 | (CodePoint >> 12)));
+			Out.Add(ANSICHAR(0x80 | ((CodePoint >> 6) & 0x3F)));
+			Out.Add(ANSICHAR(0x80 | (CodePoint & 0x3F)));
+		}
+		else
+		{
+			Out.Add(ANSICHAR(0xF0 | (CodePoint >> 18)));
+			Out.Add(ANSICHAR(0x80 | ((CodePoint >> 12) & 0x3F)));
+			Out.Add(ANSICHAR(0x80 | ((CodePoint >> 6) & 0x3F)));
+			Out.Add(ANSICHAR(0x80 | (CodePoint & 0x3F)));
+		}
+	}
+}
+
+bool FBluJsonTape::Parse(TArray<uint8>&& Utf8Document)
+{
+	Document = MoveTemp(Utf8Document);
+	Entries.Reset();
+
+	// Typical payloads have a value every 8 or so bytes, saves regrowing the tape while parsing
+	Entries.Reserve(Document.Num() / 8 + 1);
+
+	Cursor = 0;
+	Depth = 0;
+
+	if (!ParseDocument())
+	{
+		UE_LOG(LogBlu, Warning, TEXT("Failed to parse JSON near byte %d"), Cursor);
+		Entries.Reset();
+		return false;
+	}
+
+	Entries[RootIndex].Next = InvalidIndex;
+	return true;
+}
+
+bool FBluJsonTape::Parse(const ANSICHAR* Utf8Data, int32 Length)
+{
+	TArray<uint8> Copy(reinterpret_cast<const uint8*>(Utf8Data), Length);
+	return Parse(MoveTemp(Copy));
+}
+
+bool FBluJsonTape::Parse(const FString& InDocument)
+{
+	FTCHARToUTF8 Utf8(*InDocument, InDocument.Len());
+	return Parse(Utf8.Get(), Utf8.Length());
+}
+
+bool FBluJsonTape::ParseDocument()
+{
+	if (!ParseValue())
+	{
+		return false;
+	}
+
+	// Nothing but whitespace is allowed after the root value
+	SkipWhitespace();
+	return Cursor == Document.Num();
+}
+
+void FBluJsonTape::SkipWhitespace()
+{
+	const int32 Num = Document.Num();
+	while (Cursor < Num)
+	{
+		const uint8 Char = Document[Cursor];
+		if (Char != ' ' && Char != '\n' && Char != '\r' && Char != '\t')
+		{
+			return;
+		}
+		Cursor++;
+	}
+}
+
+bool FBluJsonTape::ParseValue()
+{
+	SkipWhitespace();
+	if (Cursor >= Document.Num())
+	{
+		return false;
+	}
+
+	switch (Document[Cursor])
+	{
+	case '{':
+		return ParseContainer(true);
+	case '[':
+		return ParseContainer(false);
+	case '"':
+		return ParseString();
+	case 't':
+		return ParseLiteral("true", EType::True);
+	case 'f':
+		return ParseLiteral("false", EType::False);
+	case 'n':
+		return ParseLiteral("null", EType::Null);
+	default:
+		return ParseNumber();
+	}
+}
+
+bool FBluJsonTape::ParseString()
+{
+	const uint8* Data = Document.GetData();
+	const int32 Num = Document.Num();
+
+	// Skip the opening quote
+	const int32 Start = ++Cursor;
+	bool bEscaped = false;
+
+	for (;;)
+	{
+		// Most of a string is neither a quote nor a backslash, check 8 bytes at a time
+		while (Cursor + 8 <= Num)
+		{
+			uint64 Word;
+			FMemory::Memcpy(&Word, Data + Cursor, sizeof(Word));
+			if (HasByte(Word, '"') || HasByte(Word, '\\'))
+			{
+				break;
+			}
+			Cursor += 8;
+		}
+
+		if (Cursor >= Num)
+		{
+			return false;
+		}
+
+		const uint8 Char = Data[Cursor];
+		if (Char == '"')
+		{
+			break;
+		}
+
+		if (Char == '\\')
+		{
+			if (Cursor + 1 >= Num)
+			{
+				return false;
+			}
+
+			bEscaped = true;
+			switch (Data[Cursor + 1])
+			{
+			case '"': case '\\': case '/': case 'b': case 'f': case 'n': case 'r': case 't':
+				Cursor += 2;
+				break;
+			case 'u':
+			{
+				uint32 CodePoint;
+				if (Cursor + 6 > Num || !ReadHex4(Data + Cursor + 2, CodePoint))
+				{
+					return false;
+				}
+				Cursor += 6;
+				break;
+			}
+			default:
+				return false;
+			}
+			continue;
+		}
+
+		Cursor++;
+	}
+
+	Entries.Add({ uint32(Start), uint32(Cursor - Start), Entries.Num() + 1, 0, EType::String, bEscaped });
+
+	// Skip the closing quote
+	Cursor++;
+	return true;
+}
+
+bool FBluJsonTape::ParseNumber()
+{
+	const int32 Start = Cursor;
+	const int32 Num = Document.Num();
+	const uint8* Data = Document.GetData();
+
+	// -?(0|[1-9][0-9]*)(\.[0-9]+)?([eE][+-]?[0-9]+)?
+	if (Cursor < Num && Data[Cursor] == '-')
+	{
+		Cursor++;
+	}
+
+	if (Cursor >= Num || !IsDigit(Data[Cursor]))
+	{
+		return false;
+	}
+
+	// No leading zeros
+	if (Data[Cursor++] != '0')
+	{
+		while (Cursor < Num && IsDigit(Data[Cursor]))
+		{
+			Cursor++;
+		}
+	}
+
+	if (Cursor < Num && Data[Cursor] == '.')
+	{
+		Cursor++;
+		if (Cursor >= Num || !IsDigit(Data[Cursor]))
+		{
+			return false;
+		}
+		while (Cursor < Num && IsDigit(Data[Cursor]))
+		{
+			Cursor++;
+		}
+	}
+
+	if (Cursor < Num && (Data[Cursor] == 'e' || Data[Cursor] == 'E'))
+	{
+		Cursor++;
+		if (Cursor < Num && (Data[Cursor] == '+' || Data[Cursor] == '-'))
+		{
+			Cursor++;
+		}
+		if (Cursor >= Num || !IsDigit(Data[Cursor]))
+		{
+			return false;
+		}
+		while (Cursor < Num && IsDigit(Data[Cursor]))
+		{
+			Cursor++;
+		}
+	}
+
+	Entries.Add({ uint32(Start), uint32(Cursor - Start), Entries.Num() + 1, 0, EType::Number, false });
+	return true;
+}
+
+bool FBluJsonTape::ParseLiteral(const char* Literal, EType Type)
+{
+	const int32 Length = FCStringAnsi::Strlen(Literal);
+	if (Cursor + Length > Document.Num() || FMemory::Memcmp(Document.GetData() + Cursor, Literal, Length) != 0)
+	{
+		return false;
+	}
+
+	Entries.Add({ uint32(Cursor), uint32(Length), Entries.Num() + 1, 0, Type, false });
+	Cursor += Length;
+	return true;
+}
+
+bool FBluJsonTape::ParseContainer(bool bObject)
+{
+	if (++Depth > MaxDepth)
+	{
+		return false;
+	}
+
+	const uint8 Close = bObject ? '}' : ']';
+	const int32 Index = Entries.Add({ uint32(Cursor), 0, InvalidIndex, 0, bObject ? EType::Object : EType::Array, false });
+	int32 LastChild = InvalidIndex;
+
+	// Skip the opening bracket
+	Cursor++;
+	SkipWhitespace();
+
+	if (Cursor < Document.Num() && Document[Cursor] == Close)
+	{
+		Cursor++;
+	}
+	else
+	{
+		for (;;)
+		{
+			if (bObject)
+			{
+				SkipWhitespace();
+				if (Cursor >= Document.Num() || Document[Cursor] != '"' || !ParseString())
+				{
+					return false;
+				}
+
+				SkipWhitespace();
+				if (Cursor >= Document.Num() || Document[Cursor] != ':')
+				{
+					return false;
+				}
+				Cursor++;
+			}
+
+			LastChild = Entries.Num();
+			if (!ParseValue())
+			{
+				return false;
+			}
+			Entries[Index].Count++;
+
+			SkipWhitespace();
+			if (Cursor >= Document.Num())
+			{
+				return false;
+			}
+
+			const uint8 Char = Document[Cursor++];
+			if (Char == Close)
+			{
+				break;
+			}
+			if (Char != ',')
+			{
+				return false;
+			}
+		}
+	}
+
+	if (LastChild != InvalidIndex)
+	{
+		Entries[LastChild].Next = InvalidIndex;
+	}
+
+	FEntry& Entry = Entries[Index];
+	Entry.Length = uint32(Cursor) - Entry.Offset;
+	Entry.Next = Entries.Num();
+
+	Depth--;
+	return true;
+}
+
+int32 FBluJsonTape::GetFirstChild(int32 Index) const
+{
+	return Entries[Index].Count > 0 ? Index + 1 : InvalidIndex;
+}
+
+int32 FBluJsonTape::FindField(int32 ObjectIndex, const FString& Key) const
+{
+	const FTCHARToUTF8 Utf8Key(*Key, Key.Len());
+	return FindFieldUtf8(ObjectIndex, Utf8Key.Get(), Utf8Key.Length());
+}
+
+int32 FBluJsonTape::FindFieldUtf8(int32 ObjectIndex, const ANSICHAR* Key, int32 KeyLength) const
+{
+	if (!Entries.IsValidIndex(ObjectIndex) || Entries[ObjectIndex].Type != EType::Object)
+	{
+		return InvalidIndex;
+	}
+
+	// Keys are followed by their value, the value links to the next key.
+	// Like FJsonObject the last of duplicate keys wins, so we can't stop at the first match
+	int32 Found = InvalidIndex;
+	for (int32 KeyIndex = GetFirstChild(ObjectIndex); KeyIndex != InvalidIndex; KeyIndex = Entries[KeyIndex + 1].Next)
+	{
+		if (KeyEquals(KeyIndex, Key, KeyLength))
+		{
+			Found = KeyIndex + 1;
+		}
+	}
+
+	return Found;
+}
+
+bool FBluJsonTape::KeyEquals(int32 KeyIndex, const ANSICHAR* Key, int32 KeyLength) const
+{
+	const FEntry& Entry = Entries[KeyIndex];
+	if (Entry.bEscaped)
+	{
+		FUTF8ToTCHAR Converted(Key, KeyLength);
+		return GetString(KeyIndex).Equals(FString(Converted.Length(), Converted.Get()), ESearchCase::IgnoreCase);
+	}
+
+	if (Entry.Length != uint32(KeyLength))
+	{
+		return false;
+	}
+
+	const uint8* Data = Document.GetData() + Entry.Offset;
+	for (int32 Index = 0; Index < KeyLength; Index++)
+	{
+		if (ToLowerAscii(Data[Index]) != ToLowerAscii(uint8(Key[Index])))
+		{
+			return false;
+		}
+	}
+	return true;
+}
+
+int32 FBluJsonTape::GetArrayElement(int32 ArrayIndex, int32 ElementIndex) const
+{
+	if (!Entries.IsValidIndex(ArrayIndex) || Entries[ArrayIndex].Type != EType::Array || ElementIndex < 0 || ElementIndex >= Entries[ArrayIndex].Count)
+	{
+		return InvalidIndex;
+	}
+
+	int32 Element = GetFirstChild(ArrayIndex);
+	for (int32 Skipped = 0; Skipped < ElementIndex; Skipped++)
+	{
+		Element = Entries[Element].Next;
+	}
+	return Element;
+}
+
+void FBluJsonTape::GetArrayElements(int32 ArrayIndex, TArray<int32>& OutElements) const
+{
+	OutElements.Reset();
+	if (!Entries.IsValidIndex(ArrayIndex) || Entries[ArrayIndex].Type != EType::Array)
+	{
+		return;
+	}
+
+	OutElements.Reserve(Entries[ArrayIndex].Count);
+	for (int32 Element = GetFirstChild(ArrayIndex); Element != InvalidIndex; Element = Entries[Element].Next)
+	{
+		OutElements.Add(Element);
+	}
+}
+
+bool FBluJsonTape::GetBool(int32 Index) const
+{
+	switch (Entries[Index].Type)
+	{
+	case EType::True:
+		return true;
+	case EType::Number:
+		return GetNumber(Index) != 0.0;
+	default:
+		return false;
+	}
+}
+
+double FBluJsonTape::GetNumber(int32 Index) const
+{
+	const FEntry& Entry = Entries[Index];
+	switch (Entry.Type)
+	{
+	case EType::Number:
+	{
+		// Numbers aren't terminated in the document
+		ANSICHAR Buffer[64];
+		const int32 Length = FMath::Min<int32>(Entry.Length, UE_ARRAY_COUNT(Buffer) - 1);
+		FMemory::Memcpy(Buffer, Document.GetData() + Entry.Offset, Length);
+		Buffer[Length] = 0;
+		return FCStringAnsi::Atod(Buffer);
+	}
+	case EType::String:
+		return FCString::Atod(*GetString(Index));
+	case EType::True:
+		return 1.0;
+	default:
+		return 0.0;
+	}
+}
+
+FString FBluJsonTape::GetString(int32 Index) const
+{
+	const FEntry& Entry = Entries[Index];
+	const ANSICHAR* Data = reinterpret_cast<const ANSICHAR*>(Document.GetData() + Entry.Offset);
+
+	switch (Entry.Type)
+	{
+	case EType::String:
+		break;
+	case EType::Number:
+	{
+		FUTF8ToTCHAR Converted(Data, Entry.Length);
+		return FString(Converted.Length(), Converted.Get());
+	}
+	case EType::True:
+		return TEXT("true");
+	case EType::False:
+		return TEXT("false");
+	default:
+		return FString();
+	}
+
+	if (!Entry.bEscaped)
+	{
+		FUTF8ToTCHAR Converted(Data, Entry.Length);
+		return FString(Converted.Length(), Converted.Get());
+	}
+
+	TArray<ANSICHAR> Unescaped;
+	Unescaped.Reserve(Entry.Length);
+
+	const uint8* Bytes = Document.GetData() + Entry.Offset;
+	const uint32 End = Entry.Length;
+	for (uint32 Pos = 0; Pos < End; Pos++)
+	{
+		if (Bytes[Pos] != '\\' || Pos + 1 >= End)
+		{
+			Unescaped.Add(ANSICHAR(Bytes[Pos]));
+			continue;
+		}
+
+		const uint8 Escape = Bytes[++Pos];
+		switch (Escape)
+		{
+		case 'b':
+			Unescaped.Add('\b');
+			break;
+		case 'f':
+			Unescaped.Add('\f');
+			break;
+		case 'n':
+			Unescaped.Add('\n');
+			break;
+		case 'r':
+			Unescaped.Add('\r');
+			break;
+		case 't':
+			Unescaped.Add('\t');
+			break;
+		case 'u':
+		{
+			// The digits were checked when parsing
+			uint32 CodePoint;
+			ReadHex4(Bytes + Pos + 1, CodePoint);
+			Pos += 4;
+
+			// Characters outside the BMP come as a surrogate pair
+			uint32 Low;
+			if (CodePoint >= 0xD800 && CodePoint <= 0xDBFF && Pos + 6 < End && Bytes[Pos + 1] == '\\' && Bytes[Pos + 2] == 'u'
+				&& ReadHex4(Bytes + Pos + 3, Low) && Low >= 0xDC00 && Low <= 0xDFFF)
+			{
+				CodePoint = 0x10000 + ((CodePoint - 0xD800) << 10) + (Low - 0xDC00);
+				Pos += 6;
+			}
+
+			AppendUtf8(Unescaped, CodePoint);
+			break;
+		}
+		default:
+			// \" \\ and \/
+			Unescaped.Add(ANSICHAR(Escape));
+			break;
+		}
+	}
+
+	FUTF8ToTCHAR Converted(Unescaped.GetData(), Unescaped.Num());
+	return FString(Converted.Length(), Converted.Get());
+}
+
+TSharedPtr<FJsonValue> FBluJsonTape::ToJsonValue(int32 Index) const
+{
+	switch (Entries[Index].Type)
+	{
+	case EType::False:
+		return MakeShared<FJsonValueBoolean>(false);
+	case EType::True:
+		return MakeShared<FJsonValueBoolean>(true);
+	case EType::Number:
+		return MakeShared<FJsonValueNumber>(GetNumber(Index));
+	case EType::String:
+		return MakeShared<FJsonValueString>(GetString(Index));
+	case EType::Object:
+		return MakeShared<FJsonValueObject>(ToJsonObject(Index));
+	case EType::Array:
+	{
+		TArray<TSharedPtr<FJsonValue>> Values;
+		Values.Reserve(Entries[Index].Count);
+		for (int32 Element = GetFirstChild(Index); Element != InvalidIndex; Element = Entries[Element].Next)
+		{
+			Values.Add(ToJsonValue(Element));
+		}
+		return MakeShared<FJsonValueArray>(Values);
+	}
+	default:
+		return MakeShared<FJsonValueNull>();
+	}
+}
+
+TSharedPtr<FJsonObject> FBluJsonTape::ToJsonObject(int32 Index) const
+{
+	if (!Entries.IsValidIndex(Index) || Entries[Index].Type != EType::Object)
+	{
+		return nullptr;
+	}
+
+	TSharedPtr<FJsonObject> Object = MakeShared<FJsonObject>();
+	Object->Values.Reserve(Entries[Index].Count);
+
+	for (int32 KeyIndex = GetFirstChild(Index); KeyIndex != InvalidIndex; KeyIndex = Entries[KeyIndex + 1].Next)
+	{
+		Object->SetField(GetString(KeyIndex), ToJsonValue(KeyIndex + 1));
+	}
+
+	return Object;
+}
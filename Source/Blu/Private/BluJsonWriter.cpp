@@ -0,0 +1,385 @@
+#include "BluJsonWriter.h"
+#include "Json.h"
+#include <type_traits>
+
+namespace
+{
+	// Bigger thread buffers are freed after use rather than held on to
+	const int32 MaxRetainedBufferSize = 1024 * 1024;
+
+	// Doubles hold integers exactly up to here
+	const double MaxExactInteger = 9007199254740992.0;
+
+	const ANSICHAR HexDigits[] = "0123456789abcdef";
+}
+
+template<typename CharType>
+TBluJsonWriter<CharType>::TBluJsonWriter(TArray<CharType>& InOut)
+	: Out(InOut)
+	, Start(InOut.Num())
+{
+}
+
+template<typename CharType>
+void TBluJsonWriter<CharType>::Separate()
+{
+	if (Out.Num() > Start)
+	{
+		const CharType Last = Out.Last();
+		if (Last != CharType('{') && Last != CharType('[') && Last != CharType(':'))
+		{
+			Out.Add(CharType(','));
+		}
+	}
+}
+
+template<typename CharType>
+void TBluJsonWriter<CharType>::BeginObject()
+{
+	Separate();
+	Out.Add(CharType('{'));
+}
+
+template<typename CharType>
+void TBluJsonWriter<CharType>::EndObject()
+{
+	Out.Add(CharType('}'));
+}
+
+template<typename CharType>
+void TBluJsonWriter<CharType>::BeginArray()
+{
+	Separate();
+	Out.Add(CharType('['));
+}
+
+template<typename CharType>
+void TBluJsonWriter<CharType>::EndArray()
+{
+	Out.Add(CharType(']'));
+}
+
+template<typename CharType>
+void TBluJsonWriter<CharType>::WriteKey(const FString& Key)
+{
+	Separate();
+	WriteEscaped(*Key, Key.Len());
+	Out.Add(CharType(':'));
+}
+
+template<typename CharType>
+void TBluJsonWriter<CharType>::WriteNull()
+{
+	Separate();
+	AppendAscii("null", 4);
+}
+
+template<typename CharType>
+void TBluJsonWriter<CharType>::WriteBool(bool Value)
+{
+	Separate();
+	if (Value)
+	{
+		AppendAscii("true", 4);
+	}
+	else
+	{
+		AppendAscii("false", 5);
+	}
+}
+
+template<typename CharType>
+void TBluJsonWriter<CharType>::WriteNumber(double Value)
+{
+	// JSON has no NaN or infinity
+	if (!FMath::IsFinite(Value))
+	{
+		WriteNull();
+		return;
+	}
+
+	Separate();
+
+	ANSICHAR Digits[32];
+	int32 Length;
+	if (Value == FMath::FloorToDouble(Value) && FMath::Abs(Value) < MaxExactInteger)
+	{
+		// Most numbers we send are counts and ids, skip the float formatting for them
+		Length = FCStringAnsi::Snprintf(Digits, sizeof(Digits), "%lld", (long long)Value);
+	}
+	else
+	{
+		Length = FCStringAnsi::Snprintf(Digits, sizeof(Digits), "%.17g", Value);
+	}
+	AppendAscii(Digits, Length);
+}
+
+template<typename CharType>
+void TBluJsonWriter<CharType>::WriteNumber(float Value)
+{
+	if (!FMath::IsFinite(Value) || Value == FMath::FloorToFloat(Value))
+	{
+		WriteNumber(double(Value));
+		return;
+	}
+
+	Separate();
+
+	// Enough digits to get the same float back, without the noise widening it to double would add
+	ANSICHAR Digits[32];
+	const int32 Length = FCStringAnsi::Snprintf(Digits, sizeof(Digits), "%.9g", double(Value));
+	AppendAscii(Digits, Length);
+}
+
+template<typename CharType>
+void TBluJsonWriter<CharType>::WriteString(const FString& Value)
+{
+	Separate();
+	WriteEscaped(*Value, Value.Len());
+}
+
+template<typename CharType>
+void TBluJsonWriter<CharType>::WriteArray(const TArray<float>& Values)
+{
+	BeginArray();
+	for (float Value : Values)
+	{
+		WriteNumber(Value);
+	}
+	EndArray();
+}
+
+template<typename CharType>
+void TBluJsonWriter<CharType>::WriteArray(const TArray<double>& Values)
+{
+	BeginArray();
+	for (double Value : Values)
+	{
+		WriteNumber(Value);
+	}
+	EndArray();
+}
+
+template<typename CharType>
+void TBluJsonWriter<CharType>::WriteArray(const TArray<int32>& Values)
+{
+	BeginArray();
+	for (int32 Value : Values)
+	{
+		WriteNumber(double(Value));
+	}
+	EndArray();
+}
+
+template<typename CharType>
+void TBluJsonWriter<CharType>::WriteArray(const TArray<bool>& Values)
+{
+	BeginArray();
+	for (bool Value : Values)
+	{
+		WriteBool(Value);
+	}
+	EndArray();
+}
+
+template<typename CharType>
+void TBluJsonWriter<CharType>::WriteArray(const TArray<FString>& Values)
+{
+	BeginArray();
+	for (const FString& Value : Values)
+	{
+		WriteString(Value);
+	}
+	EndArray();
+}
+
+template<typename CharType>
+void TBluJsonWriter<CharType>::WriteValue(const TSharedPtr<FJsonValue>& Value)
+{
+	if (!Value.IsValid())
+	{
+		WriteNull();
+		return;
+	}
+
+	switch (Value->Type)
+	{
+	case EJson::Boolean:
+		WriteBool(Value->AsBool());
+		break;
+	case EJson::Number:
+		WriteNumber(Value->AsNumber());
+		break;
+	case EJson::String:
+		WriteString(Value->AsString());
+		break;
+	case EJson::Array:
+		BeginArray();
+		for (const TSharedPtr<FJsonValue>& Element : Value->AsArray())
+		{
+			WriteValue(Element);
+		}
+		EndArray();
+		break;
+	case EJson::Object:
+		if (Value->AsObject().IsValid())
+		{
+			WriteObject(*Value->AsObject());
+		}
+		else
+		{
+			WriteNull();
+		}
+		break;
+	default:
+		WriteNull();
+		break;
+	}
+}
+
+template<typename CharType>
+void TBluJsonWriter<CharType>::WriteObject(const FJsonObject& Object)
+{
+	BeginObject();
+	for (const TPair<FString, TSharedPtr<FJsonValue>>& Pair : Object.Values)
+	{
+		WriteKey(Pair.Key);
+		WriteValue(Pair.Value);
+	}
+	EndObject();
+}
+
+template<typename CharType>
+void TBluJsonWriter<CharType>::AppendAscii(const ANSICHAR* Text, int32 Length)
+{
+	const int32 Index = Out.AddUninitialized(Length);
+	for (int32 Char = 0; Char < Length; Char++)
+	{
+		Out[Index + Char] = CharType(Text[Char]);
+	}
+}
+
+template<typename CharType>
+void TBluJsonWriter<CharType>::AppendText(const TCHAR* Text, int32 Length)
+{
+	if (Length <= 0)
+	{
+		return;
+	}
+
+	if constexpr (std::is_same_v<CharType, TCHAR>)
+	{
+		Out.Append(Text, Length);
+	}
+	else
+	{
+		FTCHARToUTF8 Utf8(Text, Length);
+		Out.Append(reinterpret_cast<const ANSICHAR*>(Utf8.Get()), Utf8.Length());
+	}
+}
+
+template<typename CharType>
+void TBluJsonWriter<CharType>::WriteEscaped(const TCHAR* Text, int32 Length)
+{
+	Out.Add(CharType('"'));
+
+	// Runs of characters that need no escaping are copied in one go
+	int32 RunStart = 0;
+	for (int32 Index = 0; Index < Length; Index++)
+	{
+		const TCHAR Char = Text[Index];
+		if (Char >= 0x20 && Char != TEXT('"') && Char != TEXT('\\') && Char != 0x2028 && Char != 0x2029)
+		{
+			continue;
+		}
+
+		AppendText(Text + RunStart, Index - RunStart);
+		RunStart = Index + 1;
+
+		switch (Char)
+		{
+		case TEXT('"'): AppendAscii("\\\"", 2); break;
+		case TEXT('\\'): AppendAscii("\\\\", 2); break;
+		case TEXT('\n'): AppendAscii("\\n", 2); break;
+		case TEXT('\r'): AppendAscii("\\r", 2); break;
+		case TEXT('\t'): AppendAscii("\\t", 2); break;
+		case TEXT('\b'): AppendAscii("\\b", 2); break;
+		case TEXT('\f'): AppendAscii("\\f", 2); break;
+		default:
+		{
+			const ANSICHAR Escape[] = { '\\', 'u',
+				HexDigits[(Char >> 12) & 0xF], HexDigits[(Char >> 8) & 0xF], HexDigits[(Char >> 4) & 0xF], HexDigits[Char & 0xF] };
+			AppendAscii(Escape, 6);
+			break;
+		}
+		}
+	}
+
+	AppendText(Text + RunStart, Length - RunStart);
+	Out.Add(CharType('"'));
+}
+
+template<typename CharType>
+TArray<CharType>& TBluJsonWriter<CharType>::GetThreadBuffer()
+{
+	static thread_local TArray<CharType> Buffer;
+	Buffer.Reset();
+	return Buffer;
+}
+
+template<typename CharType>
+void TBluJsonWriter<CharType>::ReleaseThreadBuffer(TArray<CharType>& Buffer)
+{
+	if (Buffer.Max() > MaxRetainedBufferSize)
+	{
+		Buffer.Empty();
+	}
+	else
+	{
+		Buffer.Reset();
+	}
+}
+
+template class TBluJsonWriter<TCHAR>;
+template class TBluJsonWriter<ANSICHAR>;
+
+FString FBluJson::ToString(const FJsonObject& Object)
+{
+	TArray<TCHAR>& Buffer = FBluJsonWriter::GetThreadBuffer();
+	FBluJsonWriter(Buffer).WriteObject(Object);
+
+	FString Result(Buffer.Num(), Buffer.GetData());
+	FBluJsonWriter::ReleaseThreadBuffer(Buffer);
+	return Result;
+}
+
+FString FBluJson::ToString(const TSharedPtr<FJsonValue>& Value)
+{
+	TArray<TCHAR>& Buffer = FBluJsonWriter::GetThreadBuffer();
+	FBluJsonWriter(Buffer).WriteValue(Value);
+
+	FString Result(Buffer.Num(), Buffer.GetData());
+	FBluJsonWriter::ReleaseThreadBuffer(Buffer);
+	return Result;
+}
+
+FString FBluJson::ToString(const TArray<TSharedPtr<FJsonValue>>& Values)
+{
+	TArray<TCHAR>& Buffer = FBluJsonWriter::GetThreadBuffer();
+	FBluJsonWriter Writer(Buffer);
+	Writer.BeginArray();
+	for (const TSharedPtr<FJsonValue>& Value : Values)
+	{
+		Writer.WriteValue(Value);
+	}
+	Writer.EndArray();
+
+	FString Result(Buffer.Num(), Buffer.GetData());
+	FBluJsonWriter::ReleaseThreadBuffer(Buffer);
+	return Result;
+}
+
+void FBluJson::ToUtf8(const FJsonObject& Object, TArray<ANSICHAR>& Out)
+{
+	FBluJsonUtf8Writer(Out).WriteObject(Object);
+}
@@ -1,4 +1,8 @@
 #include "BluManager.h"
+#include "BluRenderBenchmark.h"
+#include "IBlu.h"
+#include "Misc/ConfigCacheIni.h"
+#include "Misc/CommandLine.h"
 
 BluManager::BluManager()
 {
@@ -8,34 +12,32 @@ void BluManager::OnBeforeCommandLineProcessing(const CefString& process_type,
 	CefRefPtr< CefCommandLine > CommandLine)
 {
 
-	/////////////////
-	/**
-	* Used to pick command line switches
-	* If set to "true": CEF will use less CPU, but rendering performance will be lower. CSS3 and WebGL are not be usable
-	* If set to "false": CEF will use more CPU, but rendering will be better, CSS3 and WebGL will also be usable
-	*/
-	BluManager::CPURenderSettings = false;
-	/////////////////
-
 	CommandLine->AppendSwitch("off-screen-rendering-enabled");
 	CommandLine->AppendSwitchWithValue("off-screen-frame-rate", "60");
 	CommandLine->AppendSwitch("enable-font-antialiasing");
 	CommandLine->AppendSwitch("enable-media-stream");
 
-	// Should we use the render settings that use less CPU?
-	if (CPURenderSettings)
-	{
-		CommandLine->AppendSwitch("disable-gpu");
-		CommandLine->AppendSwitch("disable-gpu-compositing");
-		CommandLine->AppendSwitch("enable-begin-frame-scheduling");
-	}
-	else
+	/////////////////
+	/**
+	* Switches from the selected render profile
+	* "cpu": CEF will use less CPU, but rendering performance will be lower. CSS3 and WebGL are not be usable
+	* "gpu": CEF will use more CPU, but rendering will be better, CSS3 and WebGL will also be usable
+	*/
+	for (const FString& Switch : RenderProfile.Switches)
 	{
-		// Enables things like CSS3 and WebGL
-		CommandLine->AppendSwitch("enable-gpu-rasterization");
-		CommandLine->AppendSwitch("enable-webgl");
-		//CommandLine->AppendSwitch("disable-web-security");
+		FString SwitchName;
+		FString SwitchValue;
+
+		if (Switch.Split(TEXT("="), &SwitchName, &SwitchValue))
+		{
+			CommandLine->AppendSwitchWithValue(*SwitchName, *SwitchValue);
+		}
+		else
+		{
+			CommandLine->AppendSwitch(*Switch);
+		}
 	}
+	/////////////////
 
 	CommandLine->AppendSwitchWithValue("enable-blink-features", "HTMLImports");
 
@@ -49,6 +51,97 @@ void BluManager::OnBeforeCommandLineProcessing(const CefString& process_type,
 
 }
 
+TArray<FBluRenderProfile> BluManager::GetRenderProfiles()
+{
+	TArray<FBluRenderProfile> Profiles;
+
+	// Enables things like CSS3 and WebGL
+	FBluRenderProfile GPUProfile;
+	GPUProfile.Name = TEXT("gpu");
+	GPUProfile.Switches = { TEXT("enable-gpu-rasterization"), TEXT("enable-webgl") };
+	GPUProfile.bSoftwareRendering = false;
+	Profiles.Add(GPUProfile);
+
+	// Uses less CPU on machines without a usable GPU
+	FBluRenderProfile CPUProfile;
+	CPUProfile.Name = TEXT("cpu");
+	CPUProfile.Switches = { TEXT("disable-gpu"), TEXT("disable-gpu-compositing"), TEXT("enable-begin-frame-scheduling") };
+	CPUProfile.bSoftwareRendering = true;
+	Profiles.Add(CPUProfile);
+
+	// Custom profiles, e.g. +RenderProfiles=lowend:disable-gpu,disable-gpu-compositing,num-raster-threads=1
+	TArray<FString> CustomProfiles;
+	if (GConfig)
+	{
+		GConfig->GetArray(TEXT("BLUI"), TEXT("RenderProfiles"), CustomProfiles, GGameIni);
+	}
+
+	for (const FString& Entry : CustomProfiles)
+	{
+		FString Name;
+		FString SwitchList;
+		if (!Entry.Split(TEXT(":"), &Name, &SwitchList))
+		{
+			UE_LOG(LogBlu, Warning, TEXT("Ignoring render profile '%s', expected name:switch,switch"), *Entry);
+			continue;
+		}
+
+		FBluRenderProfile Profile;
+		Profile.Name = Name.TrimStartAndEnd();
+		TArray<FString> Switches;
+		SwitchList.ParseIntoArray(Switches, TEXT(","));
+		for (const FString& Switch : Switches)
+		{
+			const FString Trimmed = Switch.TrimStartAndEnd();
+			if (!Trimmed.IsEmpty())
+			{
+				Profile.Switches.Add(Trimmed);
+			}
+		}
+		Profile.bSoftwareRendering = Profile.Switches.Contains(TEXT("disable-gpu"));
+
+		// Allow overriding the built in ones
+		Profiles.RemoveAll([&Profile](const FBluRenderProfile& Existing) { return Existing.Name == Profile.Name; });
+		Profiles.Add(Profile);
+	}
+
+	return Profiles;
+}
+
+void BluManager::SelectRenderProfile()
+{
+	TArray<FBluRenderProfile> Profiles = GetRenderProfiles();
+
+	// Command line wins, then project config, then whatever a benchmark picked
+	FString ProfileName;
+	if (!FParse::Value(FCommandLine::Get(), TEXT("BluRenderProfile="), ProfileName))
+	{
+		if (!GConfig || !GConfig->GetString(TEXT("BLUI"), TEXT("RenderProfile"), ProfileName, GGameIni))
+		{
+			ProfileName = FBluRenderBenchmark::GetProfileToUse();
+		}
+	}
+
+	const FBluRenderProfile* Selected = Profiles.FindByPredicate([&ProfileName](const FBluRenderProfile& Profile)
+	{
+		return Profile.Name.Equals(ProfileName, ESearchCase::IgnoreCase);
+	});
+
+	if (!Selected)
+	{
+		if (!ProfileName.IsEmpty())
+		{
+			UE_LOG(LogBlu, Warning, TEXT("Unknown render profile '%s', using '%s'"), *ProfileName, *Profiles[0].Name);
+		}
+		Selected = &Profiles[0];
+	}
+
+	RenderProfile = *Selected;
+	CPURenderSettings = RenderProfile.bSoftwareRendering;
+
+	UE_LOG(LogBlu, Log, TEXT("Using render profile: %s"), *RenderProfile.Name);
+}
+
 void BluManager::DoBluMessageLoop()
 {
 	CefDoMessageLoopWork();
@@ -57,4 +150,6 @@ void BluManager::DoBluMessageLoop()
 CefSettings BluManager::Settings;
 CefMainArgs BluManager::MainArgs;
 bool BluManager::CPURenderSettings = false;
-bool BluManager::AutoPlay = true;
\ No newline at end of file
+bool BluManager::AutoPlay = true;
+bool BluManager::bStructuredRendererMessages = false;
+FBluRenderProfile BluManager::RenderProfile;
@@ -0,0 +1,166 @@
+#include "BluModelBinding.h"
+#include "Dom/JsonObject.h"
+#include "JsonObjectConverter.h"
+
+namespace
+{
+	void WriteProperty(FBluJsonWriter& Writer, FProperty* Property, const void* Value)
+	{
+		// Arrays of plain values are written straight from the TArray, no FJsonValue per element
+		if (const FArrayProperty* ArrayProperty = CastField<FArrayProperty>(Property))
+		{
+			const FProperty* Inner = ArrayProperty->Inner;
+			if (Inner->IsA<FFloatProperty>())
+			{
+				Writer.WriteArray(*static_cast<const TArray<float>*>(Value));
+				return;
+			}
+			if (Inner->IsA<FDoubleProperty>())
+			{
+				Writer.WriteArray(*static_cast<const TArray<double>*>(Value));
+				return;
+			}
+			if (Inner->IsA<FIntProperty>())
+			{
+				Writer.WriteArray(*static_cast<const TArray<int32>*>(Value));
+				return;
+			}
+			if (Inner->IsA<FBoolProperty>())
+			{
+				Writer.WriteArray(*static_cast<const TArray<bool>*>(Value));
+				return;
+			}
+			if (Inner->IsA<FStrProperty>())
+			{
+				Writer.WriteArray(*static_cast<const TArray<FString>*>(Value));
+				return;
+			}
+		}
+
+		Writer.WriteValue(FJsonObjectConverter::UPropertyToJsonValue(Property, Value));
+	}
+}
+
+FBluModelBinding::FBluModelBinding(UObject* InObject)
+	: Object(InObject)
+	, StructData(nullptr)
+	, Snapshot(nullptr)
+	, bSendAll(true)
+{
+	BuildFields(InObject->GetClass());
+}
+
+FBluModelBinding::FBluModelBinding(const UScriptStruct* InStruct, const void* InStructData)
+	: StructData(InStructData)
+	, Snapshot(nullptr)
+	, bSendAll(true)
+{
+	BuildFields(InStruct);
+}
+
+FBluModelBinding::~FBluModelBinding()
+{
+	for (const FBoundField& Field : Fields)
+	{
+		Field.Property->DestroyValue(Snapshot + Field.SnapshotOffset);
+	}
+	FMemory::Free(Snapshot);
+}
+
+void FBluModelBinding::BuildFields(const UStruct* Struct)
+{
+	int32 SnapshotSize = 0;
+	int32 SnapshotAlignment = 1;
+
+	// Only what Blueprints can see is part of the model
+	for (TFieldIterator<FProperty> It(Struct); It; ++It)
+	{
+		FProperty* Property = *It;
+		if (!Property->HasAnyPropertyFlags(CPF_BlueprintVisible))
+		{
+			continue;
+		}
+
+		SnapshotSize = Align(SnapshotSize, Property->GetMinAlignment());
+		SnapshotAlignment = FMath::Max(SnapshotAlignment, Property->GetMinAlignment());
+
+		Fields.Add({ Property, SnapshotSize, FJsonObjectConverter::StandardizeCase(Property->GetAuthoredName()) });
+		SnapshotSize += Property->GetSize();
+	}
+
+	Snapshot = static_cast<uint8*>(FMemory::Malloc(FMath::Max(SnapshotSize, 1), SnapshotAlignment));
+	for (const FBoundField& Field : Fields)
+	{
+		Field.Property->InitializeValue(Snapshot + Field.SnapshotOffset);
+	}
+}
+
+const void* FBluModelBinding::GetContainer() const
+{
+	return StructData ? StructData : Object.Get();
+}
+
+bool FBluModelBinding::IsValid() const
+{
+	return GetContainer() != nullptr;
+}
+
+void FBluModelBinding::MarkAllDirty()
+{
+	bSendAll = true;
+}
+
+bool FBluModelBinding::CollectChanges(FBluJsonWriter& Writer)
+{
+	const void* Container = GetContainer();
+	if (!Container)
+	{
+		return false;
+	}
+
+	bool bChanged = false;
+
+	for (const FBoundField& Field : Fields)
+	{
+		FProperty* Property = Field.Property;
+		const uint8* Value = Property->ContainerPtrToValuePtr<uint8>(Container);
+		uint8* Previous = Snapshot + Field.SnapshotOffset;
+
+		if (!bSendAll)
+		{
+			bool bIdentical = true;
+			for (int32 Index = 0; Index < Property->ArrayDim && bIdentical; Index++)
+			{
+				bIdentical = Property->Identical(Previous + Index * Property->ElementSize, Value + Index * Property->ElementSize, PPF_None);
+			}
+
+			if (bIdentical)
+			{
+				continue;
+			}
+		}
+
+		Property->CopyCompleteValue(Previous, Value);
+
+		Writer.WriteKey(Field.JsonName);
+		if (Property->ArrayDim == 1)
+		{
+			WriteProperty(Writer, Property, Value);
+		}
+		else
+		{
+			// Fixed size C arrays go out as a JS array
+			Writer.BeginArray();
+			for (int32 Index = 0; Index < Property->ArrayDim; Index++)
+			{
+				WriteProperty(Writer, Property, Value + Index * Property->ElementSize);
+			}
+			Writer.EndArray();
+		}
+
+		bChanged = true;
+	}
+
+	bSendAll = false;
+	return bChanged;
+}
@@ -0,0 +1,423 @@
+#include "BluMsgPack.h"
+#include "Json.h"
+#include "Misc/Base64.h"
+
+namespace
+{
+	// Doubles hold integers exactly up to here
+	const double MaxExactInteger = 9007199254740992.0;
+
+	// Same limit as the lazy parser, deeper data is almost certainly hostile
+	const int32 MaxDepth = 512;
+
+	void WriteBigEndian(TArray<uint8>& Out, uint64 Value, int32 NumBytes)
+	{
+		const int32 Index = Out.AddUninitialized(NumBytes);
+		for (int32 Byte = 0; Byte < NumBytes; Byte++)
+		{
+			Out[Index + Byte] = uint8(Value >> ((NumBytes - 1 - Byte) * 8));
+		}
+	}
+
+	// Type byte and length for strings, arrays and maps. Code8 is 0 for types without an 8 bit length
+	void WriteHeader(TArray<uint8>& Out, uint32 Length, uint8 FixCode, uint32 FixLimit, uint8 Code8, uint8 Code16, uint8 Code32)
+	{
+		if (Length < FixLimit)
+		{
+			Out.Add(uint8(FixCode | Length));
+		}
+		else if (Code8 && Length <= 0xFF)
+		{
+			Out.Add(Code8);
+			Out.Add(uint8(Length));
+		}
+		else if (Length <= 0xFFFF)
+		{
+			Out.Add(Code16);
+			WriteBigEndian(Out, Length, 2);
+		}
+		else
+		{
+			Out.Add(Code32);
+			WriteBigEndian(Out, Length, 4);
+		}
+	}
+
+	void WriteNumber(TArray<uint8>& Out, double Value)
+	{
+		if (Value == FMath::FloorToDouble(Value) && FMath::Abs(Value) < MaxExactInteger)
+		{
+			const int64 Integer = int64(Value);
+			if (Integer >= 0)
+			{
+				if (Integer < 0x80)
+				{
+					Out.Add(uint8(Integer));
+				}
+				else if (Integer <= 0xFF)
+				{
+					Out.Add(0xCC);
+					Out.Add(uint8(Integer));
+				}
+				else if (Integer <= 0xFFFF)
+				{
+					Out.Add(0xCD);
+					WriteBigEndian(Out, Integer, 2);
+				}
+				else if (Integer <= 0xFFFFFFFFll)
+				{
+					Out.Add(0xCE);
+					WriteBigEndian(Out, Integer, 4);
+				}
+				else
+				{
+					Out.Add(0xCF);
+					WriteBigEndian(Out, Integer, 8);
+				}
+			}
+			else if (Integer >= -32)
+			{
+				Out.Add(uint8(int8(Integer)));
+			}
+			else if (Integer >= MIN_int8)
+			{
+				Out.Add(0xD0);
+				Out.Add(uint8(int8(Integer)));
+			}
+			else if (Integer >= MIN_int16)
+			{
+				Out.Add(0xD1);
+				WriteBigEndian(Out, uint16(int16(Integer)), 2);
+			}
+			else if (Integer >= MIN_int32)
+			{
+				Out.Add(0xD2);
+				WriteBigEndian(Out, uint32(int32(Integer)), 4);
+			}
+			else
+			{
+				Out.Add(0xD3);
+				WriteBigEndian(Out, uint64(Integer), 8);
+			}
+			return;
+		}
+
+		// Half the size when nothing is lost, which covers most values that started out as floats
+		const float Single = float(Value);
+		if (double(Single) == Value)
+		{
+			uint32 Bits;
+			FMemory::Memcpy(&Bits, &Single, sizeof(Bits));
+			Out.Add(0xCA);
+			WriteBigEndian(Out, Bits, 4);
+			return;
+		}
+
+		uint64 Bits;
+		FMemory::Memcpy(&Bits, &Value, sizeof(Bits));
+		Out.Add(0xCB);
+		WriteBigEndian(Out, Bits, 8);
+	}
+
+	TSharedPtr<FJsonValue> MakeNumber(double Value)
+	{
+		return MakeShared<FJsonValueNumber>(Value);
+	}
+
+	void WriteString(TArray<uint8>& Out, const FString& Value)
+	{
+		FTCHARToUTF8 Utf8(*Value, Value.Len());
+		WriteHeader(Out, Utf8.Length(), 0xA0, 32, 0xD9, 0xDA, 0xDB);
+		Out.Append(reinterpret_cast<const uint8*>(Utf8.Get()), Utf8.Length());
+	}
+
+	class FReader
+	{
+	public:
+
+		FReader(const uint8* InData, int32 InNum)
+			: Data(InData)
+			, Num(InNum)
+		{
+		}
+
+		bool IsAtEnd() const
+		{
+			return Pos == Num;
+		}
+
+		TSharedPtr<FJsonValue> ReadValue(int32 Depth)
+		{
+			uint8 Code;
+			if (Depth > MaxDepth || !ReadByte(Code))
+			{
+				return nullptr;
+			}
+
+			if (Code < 0x80)
+			{
+				return MakeShared<FJsonValueNumber>(Code);
+			}
+			if (Code < 0x90)
+			{
+				return ReadMap(Code & 0x0F, Depth);
+			}
+			if (Code < 0xA0)
+			{
+				return ReadArray(Code & 0x0F, Depth);
+			}
+			if (Code < 0xC0)
+			{
+				return ReadString(Code & 0x1F);
+			}
+			if (Code >= 0xE0)
+			{
+				return MakeShared<FJsonValueNumber>(int8(Code));
+			}
+
+			uint64 Value = 0;
+			switch (Code)
+			{
+			case 0xC0: return MakeShared<FJsonValueNull>();
+			case 0xC2: return MakeShared<FJsonValueBoolean>(false);
+			case 0xC3: return MakeShared<FJsonValueBoolean>(true);
+			case 0xC4: return ReadLength(1, Value) ? ReadBinary(Value) : nullptr;
+			case 0xC5: return ReadLength(2, Value) ? ReadBinary(Value) : nullptr;
+			case 0xC6: return ReadLength(4, Value) ? ReadBinary(Value) : nullptr;
+			case 0xC7: return ReadLength(1, Value) ? SkipExtension(Value) : nullptr;
+			case 0xC8: return ReadLength(2, Value) ? SkipExtension(Value) : nullptr;
+			case 0xC9: return ReadLength(4, Value) ? SkipExtension(Value) : nullptr;
+			case 0xCA:
+			{
+				if (!ReadBigEndian(4, Value))
+				{
+					return nullptr;
+				}
+				const uint32 Bits = uint32(Value);
+				float Single;
+				FMemory::Memcpy(&Single, &Bits, sizeof(Single));
+				return MakeNumber(Single);
+			}
+			case 0xCB:
+			{
+				if (!ReadBigEndian(8, Value))
+				{
+					return nullptr;
+				}
+				double Double;
+				FMemory::Memcpy(&Double, &Value, sizeof(Double));
+				return MakeNumber(Double);
+			}
+			case 0xCC: return ReadBigEndian(1, Value) ? MakeNumber(double(Value)) : nullptr;
+			case 0xCD: return ReadBigEndian(2, Value) ? MakeNumber(double(Value)) : nullptr;
+			case 0xCE: return ReadBigEndian(4, Value) ? MakeNumber(double(Value)) : nullptr;
+			case 0xCF: return ReadBigEndian(8, Value) ? MakeNumber(double(Value)) : nullptr;
+			case 0xD0: return ReadBigEndian(1, Value) ? MakeNumber(double(int8(Value))) : nullptr;
+			case 0xD1: return ReadBigEndian(2, Value) ? MakeNumber(double(int16(Value))) : nullptr;
+			case 0xD2: return ReadBigEndian(4, Value) ? MakeNumber(double(int32(Value))) : nullptr;
+			case 0xD3: return ReadBigEndian(8, Value) ? MakeNumber(double(int64(Value))) : nullptr;
+			case 0xD4: return SkipExtension(1);
+			case 0xD5: return SkipExtension(2);
+			case 0xD6: return SkipExtension(4);
+			case 0xD7: return SkipExtension(8);
+			case 0xD8: return SkipExtension(16);
+			case 0xD9: return ReadLength(1, Value) ? ReadString(Value) : nullptr;
+			case 0xDA: return ReadLength(2, Value) ? ReadString(Value) : nullptr;
+			case 0xDB: return ReadLength(4, Value) ? ReadString(Value) : nullptr;
+			case 0xDC: return ReadLength(2, Value) ? ReadArray(Value, Depth) : nullptr;
+			case 0xDD: return ReadLength(4, Value) ? ReadArray(Value, Depth) : nullptr;
+			case 0xDE: return ReadLength(2, Value) ? ReadMap(Value, Depth) : nullptr;
+			case 0xDF: return ReadLength(4, Value) ? ReadMap(Value, Depth) : nullptr;
+			default:
+				// 0xC1 is never used
+				return nullptr;
+			}
+		}
+
+	private:
+
+		const uint8* Data;
+		int32 Num;
+		int32 Pos = 0;
+
+		bool ReadByte(uint8& Out)
+		{
+			if (Pos >= Num)
+			{
+				return false;
+			}
+			Out = Data[Pos++];
+			return true;
+		}
+
+		bool ReadBigEndian(int32 NumBytes, uint64& Out)
+		{
+			if (Num - Pos < NumBytes)
+			{
+				return false;
+			}
+
+			Out = 0;
+			for (int32 Byte = 0; Byte < NumBytes; Byte++)
+			{
+				Out = (Out << 8) | Data[Pos++];
+			}
+			return true;
+		}
+
+		// A length that has to fit in what's left, so a bad one can't make us allocate a huge array
+		bool ReadLength(int32 NumBytes, uint64& Out)
+		{
+			return ReadBigEndian(NumBytes, Out) && Out <= uint64(Num - Pos);
+		}
+
+		TSharedPtr<FJsonValue> ReadString(uint64 Length)
+		{
+			if (Length > uint64(Num - Pos))
+			{
+				return nullptr;
+			}
+
+			FUTF8ToTCHAR Converted(reinterpret_cast<const ANSICHAR*>(Data + Pos), int32(Length));
+			Pos += int32(Length);
+			return MakeShared<FJsonValueString>(FString(Converted.Length(), Converted.Get()));
+		}
+
+		TSharedPtr<FJsonValue> ReadBinary(uint64 Length)
+		{
+			const TArray<uint8> Bytes(Data + Pos, int32(Length));
+			Pos += int32(Length);
+			return MakeShared<FJsonValueString>(FBase64::Encode(Bytes));
+		}
+
+		TSharedPtr<FJsonValue> SkipExtension(uint64 Length)
+		{
+			// One byte of type, then the data
+			if (uint64(Num - Pos) < Length + 1)
+			{
+				return nullptr;
+			}
+			Pos += int32(Length) + 1;
+			return MakeShared<FJsonValueNull>();
+		}
+
+		TSharedPtr<FJsonValue> ReadArray(uint64 Count, int32 Depth)
+		{
+			// Every element is at least a byte
+			if (Count > uint64(Num - Pos))
+			{
+				return nullptr;
+			}
+
+			TArray<TSharedPtr<FJsonValue>> Elements;
+			Elements.Reserve(int32(Count));
+			for (uint64 Element = 0; Element < Count; Element++)
+			{
+				TSharedPtr<FJsonValue> Value = ReadValue(Depth + 1);
+				if (!Value.IsValid())
+				{
+					return nullptr;
+				}
+				Elements.Add(MoveTemp(Value));
+			}
+			return MakeShared<FJsonValueArray>(Elements);
+		}
+
+		TSharedPtr<FJsonValue> ReadMap(uint64 Count, int32 Depth)
+		{
+			if (Count * 2 > uint64(Num - Pos))
+			{
+				return nullptr;
+			}
+
+			TSharedRef<FJsonObject> Object = MakeShared<FJsonObject>();
+			Object->Values.Reserve(int32(Count));
+			for (uint64 Field = 0; Field < Count; Field++)
+			{
+				TSharedPtr<FJsonValue> Key = ReadValue(Depth + 1);
+				TSharedPtr<FJsonValue> Value = Key.IsValid() ? ReadValue(Depth + 1) : nullptr;
+				if (!Value.IsValid())
+				{
+					return nullptr;
+				}
+
+				// JSON keys are strings, numbers and the like are used as their text
+				FString KeyString;
+				if (!Key->TryGetString(KeyString))
+				{
+					return nullptr;
+				}
+				Object->Values.Add(MoveTemp(KeyString), MoveTemp(Value));
+			}
+			return MakeShared<FJsonValueObject>(Object);
+		}
+	};
+}
+
+void FBluMsgPack::Encode(const FJsonObject& Object, TArray<uint8>& Out)
+{
+	WriteHeader(Out, Object.Values.Num(), 0x80, 16, 0, 0xDE, 0xDF);
+	for (const TPair<FString, TSharedPtr<FJsonValue>>& Pair : Object.Values)
+	{
+		WriteString(Out, Pair.Key);
+		EncodeValue(Pair.Value, Out);
+	}
+}
+
+void FBluMsgPack::EncodeValue(const TSharedPtr<FJsonValue>& Value, TArray<uint8>& Out)
+{
+	if (!Value.IsValid())
+	{
+		Out.Add(0xC0);
+		return;
+	}
+
+	switch (Value->Type)
+	{
+	case EJson::Boolean:
+		Out.Add(Value->AsBool() ? 0xC3 : 0xC2);
+		break;
+	case EJson::Number:
+		WriteNumber(Out, Value->AsNumber());
+		break;
+	case EJson::String:
+		WriteString(Out, Value->AsString());
+		break;
+	case EJson::Array:
+	{
+		const TArray<TSharedPtr<FJsonValue>>& Elements = Value->AsArray();
+		WriteHeader(Out, Elements.Num(), 0x90, 16, 0, 0xDC, 0xDD);
+		for (const TSharedPtr<FJsonValue>& Element : Elements)
+		{
+			EncodeValue(Element, Out);
+		}
+		break;
+	}
+	case EJson::Object:
+		if (Value->AsObject().IsValid())
+		{
+			Encode(*Value->AsObject(), Out);
+		}
+		else
+		{
+			Out.Add(0xC0);
+		}
+		break;
+	default:
+		Out.Add(0xC0);
+		break;
+	}
+}
+
+TSharedPtr<FJsonValue> FBluMsgPack::DecodeValue(const uint8* Data, int32 NumBytes)
+{
+	FReader Reader(Data, NumBytes);
+	TSharedPtr<FJsonValue> Value = Reader.ReadValue(0);
+	return Value.IsValid() && Reader.IsAtEnd() ? Value : TSharedPtr<FJsonValue>();
+}
+
+TSharedPtr<FJsonObject> FBluMsgPack::Decode(const uint8* Data, int32 NumBytes)
+{
+	TSharedPtr<FJsonValue> Value = DecodeValue(Data, NumBytes);
+	return Value.IsValid() && Value->Type == EJson::Object ? Value->AsObject() : TSharedPtr<FJsonObject>();
+}
@@ -0,0 +1,295 @@
+#include "BluRenderBenchmark.h"
+#include "BluManager.h"
+#include "BluEye.h"
+#include "IBlu.h"
+#include "Misc/Base64.h"
+#include "Misc/ConfigCacheIni.h"
+#include "Misc/CommandLine.h"
+
+namespace
+{
+	const TCHAR* ResultsSection = TEXT("BLUI.RenderBenchmark");
+	const TCHAR* FastestKey = TEXT("FastestProfile");
+
+	// Lots of composited, shadowed and canvas-drawn content so slow profiles drop frames
+	const char* ReferencePage =
+		"<html><body style='margin:0;background:#123;overflow:hidden'>"
+		"<canvas id='c' width='1280' height='720' style='position:absolute'></canvas>"
+		"<script>"
+		"for(var i=0;i<300;i++){var d=document.createElement('div');"
+		"d.style.cssText='position:absolute;width:40px;height:40px;border-radius:8px;box-shadow:0 0 12px #fff;'"
+		"+'background:hsl('+(i*7)+',80%,60%);left:'+(i*37%1240)+'px;top:'+(i*53%680)+'px';"
+		"document.body.appendChild(d);}"
+		"var ctx=document.getElementById('c').getContext('2d'),els=document.querySelectorAll('div');"
+		"function f(t){ctx.clearRect(0,0,1280,720);for(var i=0;i<500;i++){ctx.fillStyle='hsl('+(i+t/10)%360+',70%,50%)';"
+		"ctx.beginPath();ctx.arc(640+Math.cos(i+t/500)*i,360+Math.sin(i+t/700)*i/2,6,0,6.283);ctx.fill();}"
+		"for(var j=0;j<els.length;j++){els[j].style.transform='rotate('+(t/5+j)+'deg) scale('+(1+Math.sin(t/300+j)/3)+')';}"
+		"requestAnimationFrame(f);}requestAnimationFrame(f);"
+		"</script></body></html>";
+}
+
+class BenchmarkRenderHandler : public CefRenderHandler
+{
+public:
+
+	// Bumped on every paint, so a waiting frame can tell when it has arrived
+	int32 Paints = 0;
+	double LastPaintTime = 0.0;
+
+	virtual void GetViewRect(CefRefPtr<CefBrowser> Browser, CefRect &Rect) override
+	{
+		Rect = CefRect(0, 0, 1280, 720);
+	}
+
+	virtual void OnPaint(CefRefPtr<CefBrowser> Browser, PaintElementType Type, const RectList &DirtyRects, const void *Buffer, int Width, int Height) override
+	{
+		LastPaintTime = FPlatformTime::Seconds();
+		Paints++;
+	}
+
+	IMPLEMENT_REFCOUNTING(BenchmarkRenderHandler);
+};
+
+class BenchmarkClient : public CefClient, public CefLifeSpanHandler
+{
+public:
+
+	CefRefPtr<BenchmarkRenderHandler> RenderHandlerRef;
+	bool bClosed;
+
+	BenchmarkClient() : RenderHandlerRef(new BenchmarkRenderHandler()), bClosed(false)
+	{
+
+	}
+
+	virtual CefRefPtr<CefRenderHandler> GetRenderHandler() override
+	{
+		return RenderHandlerRef;
+	}
+
+	virtual CefRefPtr<CefLifeSpanHandler> GetLifeSpanHandler() override
+	{
+		return this;
+	}
+
+	virtual void OnBeforeClose(CefRefPtr<CefBrowser> Browser) override
+	{
+		bClosed = true;
+	}
+
+	IMPLEMENT_REFCOUNTING(BenchmarkClient);
+};
+
+CefRefPtr<BenchmarkClient> FBluRenderBenchmark::Client;
+CefRefPtr<CefBrowser> FBluRenderBenchmark::Browser;
+FTSTicker::FDelegateHandle FBluRenderBenchmark::TickerHandle;
+double FBluRenderBenchmark::StartTime = 0.0;
+TArray<double> FBluRenderBenchmark::FrameTimes;
+bool FBluRenderBenchmark::bHasRun = false;
+
+bool FBluRenderBenchmark::IsEnabled()
+{
+	bool bEnabled = FParse::Param(FCommandLine::Get(), TEXT("BluRenderBenchmark"));
+
+	if (!bEnabled && GConfig)
+	{
+		GConfig->GetBool(TEXT("BLUI"), TEXT("bRunRenderBenchmark"), bEnabled, GGameIni);
+	}
+
+	return bEnabled;
+}
+
+TMap<FString, float> FBluRenderBenchmark::GetResults()
+{
+	TMap<FString, float> Results;
+
+	if (!GConfig)
+	{
+		return Results;
+	}
+
+	for (const FBluRenderProfile& Profile : BluManager::GetRenderProfiles())
+	{
+		float FrameTime = 0.f;
+		if (GConfig->GetFloat(ResultsSection, *Profile.Name, FrameTime, GGameUserSettingsIni))
+		{
+			Results.Add(Profile.Name, FrameTime);
+		}
+	}
+
+	return Results;
+}
+
+FString FBluRenderBenchmark::GetProfileToUse()
+{
+	if (!GConfig)
+	{
+		return FString();
+	}
+
+	// Still measuring, try the next profile without a result
+	if (IsEnabled())
+	{
+		const TMap<FString, float> Results = GetResults();
+		for (const FBluRenderProfile& Profile : BluManager::GetRenderProfiles())
+		{
+			if (!Results.Contains(Profile.Name))
+			{
+				return Profile.Name;
+			}
+		}
+	}
+
+	FString Fastest;
+	GConfig->GetString(ResultsSection, FastestKey, Fastest, GGameUserSettingsIni);
+	return Fastest;
+}
+
+void FBluRenderBenchmark::StartIfNeeded()
+{
+	if (bHasRun || !IsEnabled())
+	{
+		return;
+	}
+	bHasRun = true;
+
+	if (GetResults().Contains(BluManager::RenderProfile.Name))
+	{
+		return;
+	}
+
+	UE_LOG(LogBlu, Log, TEXT("Benchmarking render profile: %s"), *BluManager::RenderProfile.Name);
+
+	// We drive the frames ourselves, so the frame rate cap and our tick rate don't decide the result
+	CefWindowInfo Info;
+	Info.SetAsWindowless(0);
+	Info.external_begin_frame_enabled = true;
+
+	CefBrowserSettings BrowserSettings;
+
+	const FString PageURL = FString(TEXT("data:text/html;base64,")) + FBase64::Encode(FString(ANSI_TO_TCHAR(ReferencePage)));
+
+	Client = new BenchmarkClient();
+	Browser = CefBrowserHost::CreateBrowserSync(Info, Client.get(), *PageURL, BrowserSettings, nullptr, nullptr);
+	Browser->GetHost()->SetAudioMuted(true);
+
+	FrameTimes.Reset();
+	StartTime = FPlatformTime::Seconds();
+	TickerHandle = FTSTicker::GetCoreTicker().AddTicker(FTickerDelegate::CreateStatic(&FBluRenderBenchmark::Tick));
+}
+
+bool FBluRenderBenchmark::Tick(float DeltaTime)
+{
+	if (!UBluEye::IsEventLoopTicking())
+	{
+		BluManager::DoBluMessageLoop();
+	}
+
+	// Done measuring, keep going until CEF lets go of the browser
+	if (!Browser)
+	{
+		if (Client->bClosed)
+		{
+			Client = nullptr;
+			TickerHandle = FTSTicker::FDelegateHandle();
+			return false;
+		}
+		return true;
+	}
+
+	const bool bTimedOut = FPlatformTime::Seconds() - StartTime > TimeoutSeconds;
+	if (FrameTimes.Num() >= WarmupFrames + SampleFrames || bTimedOut)
+	{
+		Finish();
+		return true;
+	}
+
+	// Nothing worth timing until the page is up
+	if (!Browser->IsLoading())
+	{
+		MeasureFrame();
+	}
+
+	return true;
+}
+
+void FBluRenderBenchmark::MeasureFrame()
+{
+	BenchmarkRenderHandler* Handler = Client->RenderHandlerRef.get();
+	const int32 PaintsBefore = Handler->Paints;
+	const double SentTime = FPlatformTime::Seconds();
+
+	Browser->GetHost()->SendExternalBeginFrame();
+
+	// Pump until the frame comes back, so we time the profile's render work and not how often we tick.
+	// The game thread is held up while this runs, it's meant for a first launch or a loading screen
+	while (Handler->Paints == PaintsBefore && FPlatformTime::Seconds() - SentTime < MaxFrameSeconds)
+	{
+		BluManager::DoBluMessageLoop();
+		FPlatformProcess::SleepNoStats(0.f);
+	}
+
+	// A frame that never came counts as the longest we waited, a profile that drops frames should lose
+	const double FrameEnd = Handler->Paints != PaintsBefore ? Handler->LastPaintTime : SentTime + MaxFrameSeconds;
+	FrameTimes.Add((FrameEnd - SentTime) * 1000.0);
+}
+
+void FBluRenderBenchmark::Finish()
+{
+	const FString& ProfileName = BluManager::RenderProfile.Name;
+
+	Browser->GetHost()->CloseBrowser(true);
+	Browser = nullptr;
+
+	if (FrameTimes.Num() <= WarmupFrames)
+	{
+		UE_LOG(LogBlu, Warning, TEXT("Render benchmark for '%s' got too few frames (%d), not recording it"), *ProfileName, FrameTimes.Num());
+		return;
+	}
+
+	// Frames after the page has settled
+	FrameTimes.RemoveAt(0, WarmupFrames);
+	FrameTimes.Sort();
+
+	double Total = 0.0;
+	for (double FrameTime : FrameTimes)
+	{
+		Total += FrameTime;
+	}
+
+	const float Average = Total / FrameTimes.Num();
+	const float P95 = FrameTimes[FMath::Min(FrameTimes.Num() - 1, FMath::FloorToInt(FrameTimes.Num() * 0.95f))];
+
+	UE_LOG(LogBlu, Log, TEXT("Render benchmark '%s': %d frames, avg %.2f ms, p95 %.2f ms"), *ProfileName, FrameTimes.Num(), Average, P95);
+
+	GConfig->SetFloat(ResultsSection, *ProfileName, Average, GGameUserSettingsIni);
+
+	// Once everything has a result, remember the fastest
+	const TMap<FString, float> Results = GetResults();
+	if (Results.Num() == BluManager::GetRenderProfiles().Num())
+	{
+		// Profiles are tried in their listed order, gpu first, and a later one has to be clearly faster to win,
+		// so noise between profiles that perform the same doesn't decide which one we keep
+		FString Fastest;
+		float FastestTime = TNumericLimits<float>::Max();
+		for (const FBluRenderProfile& Profile : BluManager::GetRenderProfiles())
+		{
+			const float FrameTime = Results.FindRef(Profile.Name);
+			UE_LOG(LogBlu, Log, TEXT("Render profile '%s': avg %.2f ms"), *Profile.Name, FrameTime);
+			if (FrameTime < FastestTime * (1.f - RequiredMargin))
+			{
+				Fastest = Profile.Name;
+				FastestTime = FrameTime;
+			}
+		}
+
+		GConfig->SetString(ResultsSection, FastestKey, *Fastest, GGameUserSettingsIni);
+		UE_LOG(LogBlu, Log, TEXT("Fastest render profile is '%s', it will be used from the next launch"), *Fastest);
+	}
+	else
+	{
+		UE_LOG(LogBlu, Log, TEXT("Restart to benchmark the next render profile: %s"), *GetProfileToUse());
+	}
+
+	GConfig->Flush(false, GGameUserSettingsIni);
+}
@@ -0,0 +1,603 @@
+#include "BluScripts.h"
+
+namespace BluScripts
+{
+	const TCHAR* EventBatchName = TEXT("__blu_batch");
+
+	const TCHAR* EventBatching = TEXT(R"JS(
+(function() {
+	var blui = window.blui = window.blui || {};
+	if (blui.__batching || typeof window.blu_event !== 'function') {
+		return;
+	}
+	blui.__batching = true;
+
+	var send = window.blu_event;
+	var queue = [];
+	var coalesced = {};
+	var coalescedIndex = {};
+	var scheduled = false;
+
+	// Only keep the latest value of this event per frame
+	blui.coalesce = function(name, enabled) {
+		coalesced[name] = enabled !== false;
+	};
+
+	blui.flush = function() {
+		scheduled = false;
+		if (queue.length === 0) {
+			return;
+		}
+		var batch = queue;
+		queue = [];
+		coalescedIndex = {};
+		send('__blu_batch', JSON.stringify(batch));
+	};
+
+	window.blu_event = function(name, data) {
+		if (coalesced[name] && coalescedIndex.hasOwnProperty(name)) {
+			queue[coalescedIndex[name]][1] = data;
+		} else {
+			if (coalesced[name]) {
+				coalescedIndex[name] = queue.length;
+			}
+			queue.push([name, data]);
+		}
+
+		if (!scheduled) {
+			scheduled = true;
+			requestAnimationFrame(blui.flush);
+			// Hidden pages don't get animation frames
+			setTimeout(function() { if (scheduled) { blui.flush(); } }, 100);
+		}
+	};
+})();
+)JS");
+
+	const TCHAR* QueryEventName = TEXT("__blu_query");
+
+	const TCHAR* Query = TEXT(R"JS(
+(function() {
+	var blui = window.blui = window.blui || {};
+	if (blui.query) {
+		return;
+	}
+
+	var pending = {};
+	var nextId = 0;
+
+	// Ask a query handler registered on the BluEye, resolves with its response
+	blui.query = function(name, payload) {
+		return new Promise(function(resolve, reject) {
+			var id = ++nextId;
+			pending[id] = { resolve: resolve, reject: reject };
+			blu_event('__blu_query', JSON.stringify({ id: id, name: name, payload: payload === undefined ? null : payload }));
+		});
+	};
+
+	blui.__resolveQuery = function(id, ok, response) {
+		var entry = pending[id];
+		if (!entry) {
+			return;
+		}
+		delete pending[id];
+		if (ok) {
+			entry.resolve(response);
+		} else {
+			entry.reject(new Error(response));
+		}
+	};
+})();
+)JS");
+
+	const TCHAR* BulkEventName = TEXT("__blu_bulk");
+
+	const TCHAR* BulkData = TEXT(R"JS(
+(function() {
+	var blui = window.blui = window.blui || {};
+	if (blui.onBulk) {
+		return;
+	}
+
+	var listeners = {};
+
+	// Call listener(typedArray) whenever the BluEye sends data on this channel
+	blui.onBulk = function(channel, listener) {
+		(listeners[channel] = listeners[channel] || []).push(listener);
+	};
+
+	blui.offBulk = function(channel, listener) {
+		var list = listeners[channel];
+		if (list) {
+			listeners[channel] = list.filter(function(l) { return l !== listener; });
+		}
+	};
+
+	blui.__receiveBulkBuffer = function(channel, type, buffer) {
+		var ArrayType = window[type] || Uint8Array;
+		var array = new ArrayType(buffer);
+		var list = listeners[channel] || [];
+		for (var i = 0; i < list.length; i++) {
+			list[i](array, channel);
+		}
+	};
+
+	blui.__receiveBulk = function(channel, type, base64) {
+		var binary = atob(base64);
+		var bytes = new Uint8Array(binary.length);
+		for (var i = 0; i < binary.length; i++) {
+			bytes[i] = binary.charCodeAt(i);
+		}
+		blui.__receiveBulkBuffer(channel, type, bytes.buffer);
+	};
+
+	// Send a typed array or ArrayBuffer to the BluEye's bulk data listeners
+	blui.sendBulk = function(channel, data) {
+		var bytes = data instanceof ArrayBuffer ? new Uint8Array(data) : new Uint8Array(data.buffer, data.byteOffset, data.byteLength);
+		var binary = '';
+		// fromCharCode can only take so many arguments at once
+		for (var i = 0; i < bytes.length; i += 0x8000) {
+			binary += String.fromCharCode.apply(null, bytes.subarray(i, i + 0x8000));
+		}
+		blu_event('__blu_bulk', JSON.stringify({ channel: channel, data: btoa(binary) }));
+	};
+})();
+)JS");
+
+	const TCHAR* MessagePack = TEXT(R"JS(
+(function() {
+	var blui = window.blui = window.blui || {};
+	if (blui.decodeMsgPack) {
+		return;
+	}
+
+	var textDecoder = new TextDecoder();
+	var textEncoder = new TextEncoder();
+
+	// Decode MessagePack from a typed array or ArrayBuffer. Integers past 2^53 lose precision, extension types come back null
+	blui.decodeMsgPack = function(data) {
+		var bytes = data instanceof ArrayBuffer ? new Uint8Array(data) : new Uint8Array(data.buffer, data.byteOffset, data.byteLength);
+		var view = new DataView(bytes.buffer, bytes.byteOffset, bytes.byteLength);
+		var pos = 0;
+
+		function length(size) {
+			var value = size === 1 ? view.getUint8(pos) : size === 2 ? view.getUint16(pos) : view.getUint32(pos);
+			pos += size;
+			return value;
+		}
+		function str(count) {
+			var value = textDecoder.decode(bytes.subarray(pos, pos + count));
+			pos += count;
+			return value;
+		}
+		function bin(count) {
+			var value = bytes.slice(pos, pos + count);
+			pos += count;
+			return value;
+		}
+		function ext(count) {
+			pos += 1 + count;
+			return null;
+		}
+		function arr(count) {
+			var value = new Array(count);
+			for (var i = 0; i < count; i++) {
+				value[i] = read();
+			}
+			return value;
+		}
+		function map(count) {
+			var value = {};
+			for (var i = 0; i < count; i++) {
+				var key = read();
+				value[key] = read();
+			}
+			return value;
+		}
+		function num(get, size) {
+			var value = view[get](pos);
+			pos += size;
+			return value;
+		}
+		function read() {
+			var code = view.getUint8(pos++);
+			if (code < 0x80) return code;
+			if (code < 0x90) return map(code & 0x0f);
+			if (code < 0xa0) return arr(code & 0x0f);
+			if (code < 0xc0) return str(code & 0x1f);
+			if (code >= 0xe0) return code - 0x100;
+			var high;
+			switch (code) {
+			case 0xc0: return null;
+			case 0xc2: return false;
+			case 0xc3: return true;
+			case 0xc4: return bin(length(1));
+			case 0xc5: return bin(length(2));
+			case 0xc6: return bin(length(4));
+			case 0xc7: return ext(length(1));
+			case 0xc8: return ext(length(2));
+			case 0xc9: return ext(length(4));
+			case 0xca: return num('getFloat32', 4);
+			case 0xcb: return num('getFloat64', 8);
+			case 0xcc: return num('getUint8', 1);
+			case 0xcd: return num('getUint16', 2);
+			case 0xce: return num('getUint32', 4);
+			case 0xcf: high = num('getUint32', 4); return high * 4294967296 + num('getUint32', 4);
+			case 0xd0: return num('getInt8', 1);
+			case 0xd1: return num('getInt16', 2);
+			case 0xd2: return num('getInt32', 4);
+			case 0xd3: high = num('getInt32', 4); return high * 4294967296 + num('getUint32', 4);
+			case 0xd4: return ext(1);
+			case 0xd5: return ext(2);
+			case 0xd6: return ext(4);
+			case 0xd7: return ext(8);
+			case 0xd8: return ext(16);
+			case 0xd9: return str(length(1));
+			case 0xda: return str(length(2));
+			case 0xdb: return str(length(4));
+			case 0xdc: return arr(length(2));
+			case 0xdd: return arr(length(4));
+			case 0xde: return map(length(2));
+			case 0xdf: return map(length(4));
+			}
+			throw new Error('blui.decodeMsgPack: unknown type 0x' + code.toString(16));
+		}
+
+		return read();
+	};
+
+	// Encode a JSON-like value as MessagePack, typed arrays and ArrayBuffers become binary. Returns a Uint8Array
+	blui.encodeMsgPack = function(value) {
+		var buffer = new Uint8Array(256);
+		var view = new DataView(buffer.buffer);
+		var pos = 0;
+
+		function reserve(count) {
+			if (pos + count > buffer.length) {
+				var bigger = new Uint8Array(Math.max(buffer.length * 2, pos + count));
+				bigger.set(buffer);
+				buffer = bigger;
+				view = new DataView(buffer.buffer);
+			}
+		}
+		function put(set, size, v) {
+			reserve(size);
+			view[set](pos, v);
+			pos += size;
+		}
+		function bytes(b) {
+			reserve(b.length);
+			buffer.set(b, pos);
+			pos += b.length;
+		}
+		function header(count, fix, fixLimit, code8, code16, code32) {
+			if (count < fixLimit) {
+				put('setUint8', 1, fix | count);
+			} else if (code8 && count < 0x100) {
+				put('setUint8', 1, code8);
+				put('setUint8', 1, count);
+			} else if (count < 0x10000) {
+				put('setUint8', 1, code16);
+				put('setUint16', 2, count);
+			} else {
+				put('setUint8', 1, code32);
+				put('setUint32', 4, count);
+			}
+		}
+		function number(v) {
+			if (Number.isInteger(v) && v >= -2147483648 && v <= 4294967295) {
+				if (v >= 0) {
+					if (v < 0x80) {
+						put('setUint8', 1, v);
+					} else if (v < 0x100) {
+						put('setUint8', 1, 0xcc);
+						put('setUint8', 1, v);
+					} else if (v < 0x10000) {
+						put('setUint8', 1, 0xcd);
+						put('setUint16', 2, v);
+					} else {
+						put('setUint8', 1, 0xce);
+						put('setUint32', 4, v);
+					}
+				} else if (v >= -32) {
+					put('setInt8', 1, v);
+				} else if (v >= -128) {
+					put('setUint8', 1, 0xd0);
+					put('setInt8', 1, v);
+				} else if (v >= -32768) {
+					put('setUint8', 1, 0xd1);
+					put('setInt16', 2, v);
+				} else {
+					put('setUint8', 1, 0xd2);
+					put('setInt32', 4, v);
+				}
+				return;
+			}
+			put('setUint8', 1, 0xcb);
+			put('setFloat64', 8, v);
+		}
+		function write(v) {
+			if (v === null || v === undefined) {
+				put('setUint8', 1, 0xc0);
+				return;
+			}
+			switch (typeof v) {
+			case 'boolean':
+				put('setUint8', 1, v ? 0xc3 : 0xc2);
+				return;
+			case 'number':
+				number(v);
+				return;
+			case 'string':
+				var encoded = textEncoder.encode(v);
+				header(encoded.length, 0xa0, 32, 0xd9, 0xda, 0xdb);
+				bytes(encoded);
+				return;
+			}
+			if (v instanceof ArrayBuffer || ArrayBuffer.isView(v)) {
+				var raw = v instanceof ArrayBuffer ? new Uint8Array(v) : new Uint8Array(v.buffer, v.byteOffset, v.byteLength);
+				header(raw.length, 0, 0, 0xc4, 0xc5, 0xc6);
+				bytes(raw);
+				return;
+			}
+			if (Array.isArray(v)) {
+				header(v.length, 0x90, 16, 0, 0xdc, 0xdd);
+				for (var i = 0; i < v.length; i++) {
+					write(v[i]);
+				}
+				return;
+			}
+			if (typeof v.toJSON === 'function') {
+				write(v.toJSON());
+				return;
+			}
+			// Same fields JSON.stringify would keep
+			var keys = Object.keys(v).filter(function(key) { return v[key] !== undefined && typeof v[key] !== 'function'; });
+			header(keys.length, 0x80, 16, 0, 0xde, 0xdf);
+			for (var k = 0; k < keys.length; k++) {
+				write(keys[k]);
+				write(v[keys[k]]);
+			}
+		}
+
+		write(value);
+		return buffer.slice(0, pos);
+	};
+
+	// Call listener(value, channel) with what the BluEye sends through SendMessagePack. Returns the listener to hand to blui.offBulk
+	blui.onMessagePack = function(channel, listener) {
+		var wrapped = function(data) {
+			listener(blui.decodeMsgPack(data), channel);
+		};
+		blui.onBulk(channel, wrapped);
+		return wrapped;
+	};
+
+	// Send a value to the BluEye as MessagePack, it arrives through BulkDataReceived. Read it with UBluJsonObj::FromMessagePack
+	blui.sendMessagePack = function(channel, value) {
+		blui.sendBulk(channel, blui.encodeMsgPack(value));
+	};
+})();
+)JS");
+
+	const TCHAR* Models = TEXT(R"JS(
+(function() {
+	var blui = window.blui = window.blui || {};
+	if (blui.models) {
+		return;
+	}
+
+	var models = blui.models = {};
+	var watchers = {};
+
+	// Call listener(model, changed) whenever the BluEye sends new values for this model
+	blui.watchModel = function(name, listener) {
+		(watchers[name] = watchers[name] || []).push(listener);
+		if (models[name]) {
+			listener(models[name], models[name]);
+		}
+	};
+
+	blui.unwatchModel = function(name, listener) {
+		var list = watchers[name];
+		if (list) {
+			watchers[name] = list.filter(function(l) { return l !== listener; });
+		}
+	};
+
+	blui.__updateModels = function(updates) {
+		for (var name in updates) {
+			var model = models[name] = models[name] || {};
+			var changed = updates[name];
+			for (var key in changed) {
+				model[key] = changed[key];
+			}
+			var list = watchers[name] || [];
+			for (var i = 0; i < list.length; i++) {
+				list[i](model, changed);
+			}
+		}
+	};
+})();
+)JS");
+
+	const TCHAR* JsonState = TEXT(R"JS(
+(function() {
+	var blui = window.blui = window.blui || {};
+	if (blui.states) {
+		return;
+	}
+
+	var states = blui.states = {};
+	var watchers = {};
+
+	function unescapeToken(token) {
+		return token.replace(/~1/g, '/').replace(/~0/g, '~');
+	}
+
+	// Apply RFC 6902 add, remove and replace operations to doc in place. Returns doc, or its replacement if the root was replaced
+	blui.applyPatch = function(doc, ops) {
+		for (var i = 0; i < ops.length; i++) {
+			var op = ops[i];
+			if (op.path === '') {
+				if (op.op === 'add' || op.op === 'replace') {
+					doc = op.value;
+				}
+				continue;
+			}
+
+			var tokens = op.path.split('/').slice(1).map(unescapeToken);
+			var key = tokens.pop();
+			var parent = doc;
+			for (var t = 0; t < tokens.length; t++) {
+				parent = parent[tokens[t]];
+			}
+
+			var isArray = Array.isArray(parent);
+			if (op.op === 'add') {
+				if (isArray) {
+					parent.splice(key === '-' ? parent.length : +key, 0, op.value);
+				} else {
+					parent[key] = op.value;
+				}
+			} else if (op.op === 'remove') {
+				if (isArray) {
+					parent.splice(+key, 1);
+				} else {
+					delete parent[key];
+				}
+			} else if (op.op === 'replace') {
+				parent[isArray ? +key : key] = op.value;
+			} else {
+				throw new Error('blui.applyPatch: unsupported op ' + op.op);
+			}
+		}
+		return doc;
+	};
+
+	// Call listener(state, ops) whenever the BluEye changes this state, ops is null when it was sent whole
+	blui.watchState = function(name, listener) {
+		(watchers[name] = watchers[name] || []).push(listener);
+		if (states[name]) {
+			listener(states[name], null);
+		}
+	};
+
+	blui.unwatchState = function(name, listener) {
+		var list = watchers[name];
+		if (list) {
+			watchers[name] = list.filter(function(l) { return l !== listener; });
+		}
+	};
+
+	function notify(name, ops) {
+		var list = watchers[name] || [];
+		for (var i = 0; i < list.length; i++) {
+			list[i](states[name], ops);
+		}
+	}
+
+	blui.__setState = function(name, state) {
+		states[name] = state;
+		notify(name, null);
+	};
+
+	blui.__patchState = function(name, ops) {
+		if (!(name in states)) {
+			return;
+		}
+		states[name] = blui.applyPatch(states[name], ops);
+		notify(name, ops);
+	};
+
+	blui.__clearState = function(name) {
+		delete states[name];
+	};
+})();
+)JS");
+
+	const TCHAR* Ready = TEXT(R"JS(
+(function() {
+	window.blui = window.blui || {};
+	window.blui.ready = true;
+	window.dispatchEvent(new Event('bluiready'));
+})();
+)JS");
+
+	const TCHAR* EvaluateResultName = TEXT("__blu_eval");
+
+	FString MakeEvaluateScript(int32 RequestId, const FString& Code)
+	{
+		// Promises are waited on, anything JSON can't represent is sent as its string form
+		return FString::Printf(TEXT(R"JS(
+(function() {
+	var id = %d;
+	function reply(ok, value) {
+		var message;
+		try {
+			message = JSON.stringify({ id: id, ok: ok, value: value });
+		} catch (e) {
+			message = JSON.stringify({ id: id, ok: ok, value: String(value) });
+		}
+		blu_event('__blu_eval', message);
+	}
+	function fail(e) {
+		reply(false, String(e && e.message || e));
+	}
+	try {
+		var result = (0, eval)(%s);
+		if (result && typeof result.then === 'function') {
+			result.then(function(value) { reply(true, value); }, fail);
+		} else {
+			reply(true, result);
+		}
+	} catch (e) {
+		fail(e);
+	}
+})();
+)JS"), RequestId, *QuoteString(Code));
+	}
+
+	FString QuoteString(const FString& Value)
+	{
+		FString Quoted;
+		Quoted.Reserve(Value.Len() + 2);
+		Quoted += TEXT('"');
+
+		for (TCHAR Char : Value)
+		{
+			switch (Char)
+			{
+			case TEXT('"'):
+				Quoted += TEXT("\\\"");
+				break;
+			case TEXT('\\'):
+				Quoted += TEXT("\\\\");
+				break;
+			case TEXT('\n'):
+				Quoted += TEXT("\\n");
+				break;
+			case TEXT('\r'):
+				Quoted += TEXT("\\r");
+				break;
+			case TEXT('\t'):
+				Quoted += TEXT("\\t");
+				break;
+			default:
+				// Control characters and the line separators JS doesn't allow raw in older engines
+				if (Char < 0x20 || Char == 0x2028 || Char == 0x2029)
+				{
+					Quoted += FString::Printf(TEXT("\\u%04x"), uint32(Char));
+				}
+				else
+				{
+					Quoted += Char;
+				}
+				break;
+			}
+		}
+
+		Quoted += TEXT('"');
+		return Quoted;
+	}
+}
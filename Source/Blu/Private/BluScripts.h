@@ -0,0 +1,49 @@
+#pragma once
+
+#include "CoreMinimal.h"
+
+/**
+ * Javascript helpers BLUI injects into its pages once they finish loading.
+ * They only rely on the blu_event function the render process exposes, and all live on window.blui.
+ */
+namespace BluScripts
+{
+	// Event name the batching helper sends its buffered events under
+	extern const TCHAR* EventBatchName;
+
+	// Buffers blu_event calls and sends them as one event per animation frame
+	extern const TCHAR* EventBatching;
+
+	// Event name blui.query sends its requests under
+	extern const TCHAR* QueryEventName;
+
+	// blui.query(name, payload), returns a promise answered by a query handler on the BluEye
+	extern const TCHAR* Query;
+
+	// Event name blui.sendBulk sends its data under
+	extern const TCHAR* BulkEventName;
+
+	// blui.onBulk/blui.sendBulk, binary buffers to and from the BluEye as typed arrays
+	extern const TCHAR* BulkData;
+
+	// blui.encodeMsgPack/blui.decodeMsgPack, and blui.onMessagePack/blui.sendMessagePack on top of the bulk channel
+	extern const TCHAR* MessagePack;
+
+	// blui.models, objects bound with BindModel kept up to date with what changed each tick
+	extern const TCHAR* Models;
+
+	// blui.states, JSON documents synced with SyncJsonState and kept up to date with patches, and blui.applyPatch
+	extern const TCHAR* JsonState;
+
+	// Fires a 'bluiready' event on window once every helper is installed
+	extern const TCHAR* Ready;
+
+	// Event name EvaluateJS results come back under
+	extern const TCHAR* EvaluateResultName;
+
+	// Wraps Code so its result, or what it threw, is sent back tagged with RequestId
+	FString MakeEvaluateScript(int32 RequestId, const FString& Code);
+
+	// Quote a string as a JS/JSON string literal
+	FString QuoteString(const FString& Value);
+}
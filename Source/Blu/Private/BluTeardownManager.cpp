@@ -0,0 +1,99 @@
+#include "BluTeardownManager.h"
+#include "IBlu.h"
+#include "BluManager.h"
+#include "BluEye.h"
+#include "RenderHandler.h"
+
+TArray<FBluTeardownManager::FClosingBrowser> FBluTeardownManager::QueuedCloses;
+TArray<FBluTeardownManager::FClosingBrowser> FBluTeardownManager::ActiveCloses;
+FTSTicker::FDelegateHandle FBluTeardownManager::TickerHandle;
+
+void FBluTeardownManager::QueueClose(CefRefPtr<CefBrowser> Browser, CefRefPtr<BrowserClient> Client)
+{
+	if (!Browser)
+	{
+		return;
+	}
+
+	// The eye is going away, make sure CEF can't call back into it while closing
+	if (Client)
+	{
+		Client->GetRenderHandlerCustom()->ParentUI = nullptr;
+	}
+
+	FClosingBrowser Entry;
+	Entry.Browser = Browser;
+	Entry.Client = Client;
+	Entry.CloseRequestTime = FPlatformTime::Seconds();
+	Entry.bClosed = false;
+	QueuedCloses.Add(Entry);
+
+	if (!TickerHandle.IsValid())
+	{
+		TickerHandle = FTSTicker::GetCoreTicker().AddTicker(FTickerDelegate::CreateStatic(&FBluTeardownManager::Tick));
+	}
+}
+
+void FBluTeardownManager::NotifyClosed(int32 BrowserId)
+{
+	// Only flag it here, releasing the client from inside its own callback isn't safe
+	for (FClosingBrowser& Entry : ActiveCloses)
+	{
+		if (Entry.Browser->GetIdentifier() == BrowserId)
+		{
+			Entry.bClosed = true;
+		}
+	}
+}
+
+bool FBluTeardownManager::HasPendingCloses()
+{
+	return QueuedCloses.Num() > 0 || ActiveCloses.Num() > 0;
+}
+
+bool FBluTeardownManager::Tick(float DeltaTime)
+{
+	// Issue everything queued this frame in one go
+	for (FClosingBrowser& Entry : QueuedCloses)
+	{
+		CefRefPtr<CefBrowserHost> Host = Entry.Browser->GetHost();
+		Host->SetAudioMuted(true);
+		Host->CloseDevTools();
+		Host->CloseBrowser(true);
+
+		ActiveCloses.Add(Entry);
+	}
+	QueuedCloses.Reset();
+
+	// The last eye may already have removed its pump, CEF still needs it to finish closing
+	if (!UBluEye::IsEventLoopTicking())
+	{
+		BluManager::DoBluMessageLoop();
+	}
+
+	const double Now = FPlatformTime::Seconds();
+	ActiveCloses.RemoveAll([Now](const FClosingBrowser& Entry)
+	{
+		if (Entry.bClosed)
+		{
+			return true;
+		}
+
+		if (Now - Entry.CloseRequestTime > CloseTimeoutSeconds)
+		{
+			UE_LOG(LogBlu, Warning, TEXT("Browser %d did not close in time, releasing it"), Entry.Browser->GetIdentifier());
+			return true;
+		}
+
+		return false;
+	});
+
+	if (!HasPendingCloses())
+	{
+		TickerHandle = FTSTicker::FDelegateHandle();
+		UE_LOG(LogBlu, Log, TEXT("All browsers closed"));
+		return false;
+	}
+
+	return true;
+}
@@ -1,12 +1,18 @@
 #include "RenderHandler.h"
 #include "Interfaces/IPluginManager.h"
 #include "BluEye.h"
+#include "BluTeardownManager.h"
+#include "BluScripts.h"
+#include "IBlu.h"
+#include "Json.h"
+#include "Misc/Base64.h"
 
 RenderHandler::RenderHandler(int32 Width, int32 Height, UBluEye* UI)
 {
 	this->Width = Width;
 	this->Height = Height;
 	this->ParentUI = UI;
+	this->bPaintingEnabled = true;
 }
 
 void RenderHandler::GetViewRect(CefRefPtr<CefBrowser> Browser, CefRect &Rect)
@@ -16,6 +22,12 @@ void RenderHandler::GetViewRect(CefRefPtr<CefBrowser> Browser, CefRect &Rect)
 
 void RenderHandler::OnPaint(CefRefPtr<CefBrowser> Browser, PaintElementType Type, const RectList &DirtyRects, const void *Buffer, int InWidth, int InHeight)
 {
+	// Our UI is gone and the browser is being torn down, or we're rendering hidden
+	if (!ParentUI || !bPaintingEnabled)
+	{
+		return;
+	}
+
 	FUpdateTextureRegion2D *UpdateRegions = static_cast<FUpdateTextureRegion2D*>(FMemory::Malloc(sizeof(FUpdateTextureRegion2D) * DirtyRects.size()));
 
 	int Current = 0;
@@ -51,12 +63,42 @@ void BrowserClient::OnBeforeClose(CefRefPtr<CefBrowser> Browser)
 	{
 		BrowserRef.reset();
 	}
+
+	FBluTeardownManager::NotifyClosed(Browser->GetIdentifier());
+}
+
+void BrowserClient::OnLoadStart(CefRefPtr<CefBrowser> Browser, CefRefPtr<CefFrame> Frame, TransitionType Transition)
+{
+	if (Frame->IsMain() && RenderHandlerRef->ParentUI)
+	{
+		RenderHandlerRef->ParentUI->OnBrowserLoadStart(Browser);
+	}
+}
+
+void BrowserClient::OnLoadingStateChange(CefRefPtr<CefBrowser> Browser, bool bIsLoading, bool bCanGoBack, bool bCanGoForward)
+{
+	if (!bIsLoading && RenderHandlerRef->ParentUI)
+	{
+		RenderHandlerRef->ParentUI->OnBrowserLoadComplete(Browser);
+	}
+}
+
+void BrowserClient::OnRenderProcessTerminated(CefRefPtr<CefBrowser> Browser, TerminationStatus Status)
+{
+	if (RenderHandlerRef->ParentUI)
+	{
+		RenderHandlerRef->ParentUI->OnRenderProcessTerminated(Browser, Status);
+	}
 }
 
 bool BrowserClient::OnConsoleMessage(CefRefPtr<CefBrowser> Browser, cef_log_severity_t Level, const CefString& Message, const CefString& source, int line)
 {
-	FString LogMessage = FString(Message.c_str());
-	LogEmitter->Broadcast(LogMessage);
+	if (!RenderHandlerRef->ParentUI)
+	{
+		return false;
+	}
+
+	RenderHandlerRef->ParentUI->DispatchLogMessage(FString(Message.c_str()));
 	return true;
 }
 
@@ -67,8 +109,12 @@ void BrowserClient::OnFullscreenModeChange(CefRefPtr< CefBrowser > Browser, bool
 
 void BrowserClient::OnTitleChange(CefRefPtr< CefBrowser > Browser, const CefString& Title)
 {
-	FString TitleMessage = FString(Title.c_str());
-	LogEmitter->Broadcast(TitleMessage);
+	if (!RenderHandlerRef->ParentUI)
+	{
+		return;
+	}
+
+	RenderHandlerRef->ParentUI->DispatchLogMessage(FString(Title.c_str()));
 }
 
 CefRefPtr<CefBrowser> BrowserClient::GetCEFBrowser()
@@ -76,30 +122,267 @@ CefRefPtr<CefBrowser> BrowserClient::GetCEFBrowser()
 	return BrowserRef;
 }
 
+TSharedPtr<FJsonValue> CefValueToJson(CefRefPtr<CefValue> Value)
+{
+	switch (Value->GetType())
+	{
+	case VTYPE_BOOL:
+		return MakeShared<FJsonValueBoolean>(Value->GetBool());
+	case VTYPE_INT:
+		return MakeShared<FJsonValueNumber>(Value->GetInt());
+	case VTYPE_DOUBLE:
+		return MakeShared<FJsonValueNumber>(Value->GetDouble());
+	case VTYPE_STRING:
+		return MakeShared<FJsonValueString>(FString(Value->GetString().c_str()));
+	case VTYPE_BINARY:
+	{
+		// JSON has no binary type, nested blobs become base64
+		CefRefPtr<CefBinaryValue> Binary = Value->GetBinary();
+		TArray<uint8> Bytes;
+		Bytes.SetNumUninitialized(Binary->GetSize());
+		Binary->GetData(Bytes.GetData(), Bytes.Num(), 0);
+		return MakeShared<FJsonValueString>(FBase64::Encode(Bytes));
+	}
+	case VTYPE_LIST:
+	{
+		CefRefPtr<CefListValue> List = Value->GetList();
+		TArray<TSharedPtr<FJsonValue>> Array;
+		Array.Reserve(List->GetSize());
+		for (size_t Index = 0; Index < List->GetSize(); Index++)
+		{
+			Array.Add(CefValueToJson(List->GetValue(Index)));
+		}
+		return MakeShared<FJsonValueArray>(Array);
+	}
+	case VTYPE_DICTIONARY:
+	{
+		CefRefPtr<CefDictionaryValue> Dictionary = Value->GetDictionary();
+		CefDictionaryValue::KeyList Keys;
+		Dictionary->GetKeys(Keys);
+
+		TSharedPtr<FJsonObject> Object = MakeShared<FJsonObject>();
+		for (const CefString& Key : Keys)
+		{
+			Object->SetField(FString(Key.c_str()), CefValueToJson(Dictionary->GetValue(Key)));
+		}
+		return MakeShared<FJsonValueObject>(Object);
+	}
+	default:
+		return MakeShared<FJsonValueNull>();
+	}
+}
+
+CefRefPtr<CefValue> JsonToCefValue(const TSharedPtr<FJsonValue>& Value)
+{
+	CefRefPtr<CefValue> Result = CefValue::Create();
+
+	if (!Value.IsValid())
+	{
+		Result->SetNull();
+		return Result;
+	}
+
+	switch (Value->Type)
+	{
+	case EJson::Boolean:
+		Result->SetBool(Value->AsBool());
+		break;
+	case EJson::Number:
+		Result->SetDouble(Value->AsNumber());
+		break;
+	case EJson::String:
+		Result->SetString(*Value->AsString());
+		break;
+	case EJson::Array:
+	{
+		const TArray<TSharedPtr<FJsonValue>>& Array = Value->AsArray();
+		CefRefPtr<CefListValue> List = CefListValue::Create();
+		List->SetSize(Array.Num());
+		for (int32 Index = 0; Index < Array.Num(); Index++)
+		{
+			List->SetValue(Index, JsonToCefValue(Array[Index]));
+		}
+		Result->SetList(List);
+		break;
+	}
+	case EJson::Object:
+	{
+		CefRefPtr<CefDictionaryValue> Dictionary = CefDictionaryValue::Create();
+		for (const TPair<FString, TSharedPtr<FJsonValue>>& Field : Value->AsObject()->Values)
+		{
+			Dictionary->SetValue(*Field.Key, JsonToCefValue(Field.Value));
+		}
+		Result->SetDictionary(Dictionary);
+		break;
+	}
+	default:
+		Result->SetNull();
+		break;
+	}
+
+	return Result;
+}
+
+// Read argument Index as whatever type the render process sent it as
+static void ReadEventPayload(CefRefPtr<CefListValue> Args, size_t Index, FBluEventPayload& OutPayload)
+{
+	switch (Args->GetType(Index))
+	{
+	case VTYPE_BOOL:
+		OutPayload.Type = EBluEventValueType::Bool;
+		OutPayload.BoolValue = Args->GetBool(Index);
+		break;
+	case VTYPE_INT:
+		OutPayload.Type = EBluEventValueType::Int;
+		OutPayload.IntValue = Args->GetInt(Index);
+		break;
+	case VTYPE_DOUBLE:
+		OutPayload.Type = EBluEventValueType::Double;
+		OutPayload.DoubleValue = Args->GetDouble(Index);
+		break;
+	case VTYPE_STRING:
+		OutPayload.Type = EBluEventValueType::String;
+		OutPayload.StringValue = FString(Args->GetString(Index).c_str());
+		break;
+	case VTYPE_LIST:
+		OutPayload.Type = EBluEventValueType::List;
+		OutPayload.StructuredValue = CefValueToJson(Args->GetValue(Index));
+		break;
+	case VTYPE_DICTIONARY:
+		OutPayload.Type = EBluEventValueType::Dictionary;
+		OutPayload.StructuredValue = CefValueToJson(Args->GetValue(Index));
+		break;
+	case VTYPE_BINARY:
+	{
+		CefRefPtr<CefBinaryValue> Binary = Args->GetBinary(Index);
+		OutPayload.Type = EBluEventValueType::Binary;
+		OutPayload.BinaryValue.SetNumUninitialized(Binary->GetSize());
+		Binary->GetData(OutPayload.BinaryValue.GetData(), OutPayload.BinaryValue.Num(), 0);
+		break;
+	}
+	default:
+		OutPayload.Type = EBluEventValueType::None;
+		break;
+	}
+}
+
+// Batched events arrive as JSON, keep their values as typed as a direct event would be
+static void JsonToEventPayload(const TSharedPtr<FJsonValue>& Value, FBluEventPayload& OutPayload)
+{
+	switch (Value->Type)
+	{
+	case EJson::Boolean:
+		OutPayload.Type = EBluEventValueType::Bool;
+		OutPayload.BoolValue = Value->AsBool();
+		break;
+	case EJson::Number:
+	{
+		const double Number = Value->AsNumber();
+		if (Number == FMath::FloorToDouble(Number) && FMath::Abs(Number) <= MAX_int32)
+		{
+			OutPayload.Type = EBluEventValueType::Int;
+			OutPayload.IntValue = int32(Number);
+		}
+		else
+		{
+			OutPayload.Type = EBluEventValueType::Double;
+			OutPayload.DoubleValue = Number;
+		}
+		break;
+	}
+	case EJson::String:
+		OutPayload.Type = EBluEventValueType::String;
+		OutPayload.StringValue = Value->AsString();
+		break;
+	case EJson::Array:
+		OutPayload.Type = EBluEventValueType::List;
+		OutPayload.StructuredValue = Value;
+		break;
+	case EJson::Object:
+		OutPayload.Type = EBluEventValueType::Dictionary;
+		OutPayload.StructuredValue = Value;
+		break;
+	default:
+		OutPayload.Type = EBluEventValueType::None;
+		break;
+	}
+}
+
+// Unpack [[name, data], ...] sent by the page's batching helper in one pass
+static void DispatchEventBatch(UBluEye* ParentUI, const FString& BatchJson)
+{
+	TArray<TSharedPtr<FJsonValue>> Batch;
+	TSharedRef<TJsonReader<TCHAR>> Reader = TJsonReaderFactory<TCHAR>::Create(BatchJson);
+	if (!FJsonSerializer::Deserialize(Reader, Batch))
+	{
+		UE_LOG(LogBlu, Warning, TEXT("Failed to parse batched script events"));
+		return;
+	}
+
+	for (const TSharedPtr<FJsonValue>& Entry : Batch)
+	{
+		const TArray<TSharedPtr<FJsonValue>>* Pair = nullptr;
+		if (!Entry->TryGetArray(Pair) || Pair->Num() < 2)
+		{
+			continue;
+		}
+
+		FBluEventPayload Payload;
+		JsonToEventPayload((*Pair)[1], Payload);
+
+		ParentUI->DispatchScriptEvent((*Pair)[0]->AsString(), Payload);
+	}
+}
+
 bool BrowserClient::OnProcessMessageReceived(CefRefPtr<CefBrowser> Browser, CefRefPtr<CefFrame> Frame, CefProcessId SourceProcess, CefRefPtr<CefProcessMessage> Message)
 {
-	FString Data;
-	FString Name = FString(UTF8_TO_TCHAR(Message->GetArgumentList()->GetString(0).ToString().c_str()));
-	FString Type = FString(UTF8_TO_TCHAR(Message->GetArgumentList()->GetString(2).ToString().c_str()));
-	FString DataType = FString(UTF8_TO_TCHAR(Message->GetArgumentList()->GetString(3).ToString().c_str()));
+	if (!RenderHandlerRef->ParentUI)
+	{
+		return false;
+	}
 
-	if (Type == "js_event")
+	// Not a global, libcef may not be loaded yet during static init
+	static const CefString JsEventType("js_event");
+	static const CefString BulkMessageName("blu_bulk");
+
+	CefRefPtr<CefListValue> Args = Message->GetArgumentList();
+
+	// Structured render processes send bulk data as [channel, binary], no base64 on the way
+	if (Message->GetName() == BulkMessageName)
+	{
+		if (Args->GetSize() < 2 || Args->GetType(1) != VTYPE_BINARY)
+		{
+			return false;
+		}
+
+		CefRefPtr<CefBinaryValue> Binary = Args->GetBinary(1);
+		TArray<uint8> Data;
+		Data.SetNumUninitialized(Binary->GetSize());
+		Binary->GetData(Data.GetData(), Data.Num(), 0);
+
+		RenderHandlerRef->ParentUI->DispatchBulkData(FName(*FString(Args->GetString(0).c_str())), Data);
+		return true;
+	}
+
+	// Arguments are [name, data, type, data type], the data's CEF value type tells us what it is
+	if (Args->GetSize() < 3 || Args->GetString(2) != JsEventType)
 	{
+		return false;
+	}
 
-		// Check the datatype
+	const FString Name = FString(Args->GetString(0).c_str());
 
-		if (DataType == "bool")
-			Data = Message->GetArgumentList()->GetBool(1) ? TEXT("true") : TEXT("false");
-		else if (DataType == "int")
-			Data = FString::FromInt(Message->GetArgumentList()->GetInt(1));
-		else if (DataType == "string")
-			Data = FString(UTF8_TO_TCHAR(Message->GetArgumentList()->GetString(1).ToString().c_str()));
-		else if (DataType == "double")
-			Data = FString::SanitizeFloat(Message->GetArgumentList()->GetDouble(1));
+	FBluEventPayload Payload;
+	ReadEventPayload(Args, 1, Payload);
 
-		EventEmitter->Broadcast(Name, Data);
+	if (Payload.Type == EBluEventValueType::String && Name == BluScripts::EventBatchName)
+	{
+		DispatchEventBatch(RenderHandlerRef->ParentUI, Payload.StringValue);
+		return true;
 	}
 
+	RenderHandlerRef->ParentUI->DispatchScriptEvent(Name, Payload);
+
 	return true;
 }
 
@@ -120,16 +403,6 @@ FString UtilityBLUIDownloadsFolder()
 }
 
 
-void BrowserClient::SetEventEmitter(FScriptEvent* Emitter)
-{
-	this->EventEmitter = Emitter;
-}
-
-void BrowserClient::SetLogEmitter(FLogEvent* Emitter)
-{
-	this->LogEmitter = Emitter;
-}
-
 void BrowserClient::OnBeforeDownload(
 	CefRefPtr<CefBrowser> Browser,
 	CefRefPtr<CefDownloadItem> DownloadItem,
@@ -157,13 +430,18 @@ void BrowserClient::OnDownloadUpdated(
 	
 	UE_LOG(LogClass, Log, TEXT("Download %s Updated: %d"), *Url , Percentage);
 
-	RenderHandlerRef->ParentUI->DownloadUpdated.Broadcast(Url, Percentage);
+	if (!RenderHandlerRef->ParentUI)
+	{
+		return;
+	}
 
-	if (Percentage == 100 && DownloadItem->IsComplete()) {
+	const bool bComplete = Percentage == 100 && DownloadItem->IsComplete();
+	if (bComplete) {
 		UE_LOG(LogClass, Log, TEXT("Download %s Complete"), *Url);
-		RenderHandlerRef->ParentUI->DownloadComplete.Broadcast(Url);
 	}
 
+	RenderHandlerRef->ParentUI->DispatchDownloadUpdated(Url, Percentage, bComplete);
+
 	//Example download cancel/pause etc, we just have to hijack this
 	//callback->Cancel();
 }
@@ -24,9 +24,29 @@ class BLU_API UBluBlueprintFunctionLibrary : public UBlueprintFunctionLibrary
 	UFUNCTION(BlueprintCallable, meta = (DisplayName = "Parse JSON String", Keywords = "blui blu eye json parse"), Category = Blu)
 	static UBluJsonObj* ParseJSON(const FString& JSONString);
 
+	/** Parse JSON that's mostly read from, fields are only decoded when they're asked for */
+	UFUNCTION(BlueprintCallable, meta = (DisplayName = "Parse JSON String (Lazy)", Keywords = "blui blu eye json parse lazy"), Category = Blu)
+	static UBluJsonObj* ParseJSONLazy(const FString& JSONString);
+
 	UFUNCTION(BlueprintCallable, meta = (DisplayName = "JSON To String", Keywords = "blui blu eye json parse string"), Category = Blu)
 	static FString JSONToString(UBluJsonObj *ObjectToParse);
 
+	/** Parse on a worker thread, for large strings that would hold up a frame. Result is empty if it didn't parse */
+	UFUNCTION(BlueprintCallable, meta = (Latent, LatentInfo = "LatentInfo", HidePin = "WorldContextObject", DefaultToSelf = "WorldContextObject", DisplayName = "Parse JSON String Async", Keywords = "blui blu eye json parse async thread"), Category = Blu)
+	static void ParseJSONAsync(UObject* WorldContextObject, const FString& JSONString, UBluJsonObj*& Result, bool& bSuccess, FLatentActionInfo LatentInfo);
+
+	/** Serialize on a worker thread. Don't change the object until this has finished */
+	UFUNCTION(BlueprintCallable, meta = (Latent, LatentInfo = "LatentInfo", HidePin = "WorldContextObject", DefaultToSelf = "WorldContextObject", DisplayName = "JSON To String Async", Keywords = "blui blu eye json string async thread"), Category = Blu)
+	static void JSONToStringAsync(UObject* WorldContextObject, UBluJsonObj* ObjectToParse, FString& Result, FLatentActionInfo LatentInfo);
+
+	/** Name of the render profile CEF was started with */
+	UFUNCTION(BlueprintPure, meta = (DisplayName = "Get BLUI Render Profile", Keywords = "blui render profile gpu cpu"), Category = Blu)
+	static FString GetRenderProfile();
+
+	/** Average frame time in ms for each render profile the benchmark has measured */
+	UFUNCTION(BlueprintPure, meta = (DisplayName = "Get BLUI Render Benchmark Results", Keywords = "blui render profile benchmark"), Category = Blu)
+	static TMap<FString, float> GetRenderBenchmarkResults();
+
 	/** convert regular key events into char event which you can use char press*/
 	UFUNCTION(BlueprintPure, meta = (DisplayName = "To CharacterEvent (Key)", BlueprintAutocast), Category = Blu)
 	static FCharacterEvent ToKeyEvent(FKey Key);
@@ -3,6 +3,9 @@
 #include "RenderHandler.h"
 #include "BluTypes.h"
 #include "BluManager.h"
+#include "BluJsonObj.h"
+#include "BluModelBinding.h"
+#include "Engine/LatentActionManager.h"
 #include "UObject/Object.h"
 #include "BluEye.generated.h"
 
@@ -22,6 +25,11 @@ public:
 	UPROPERTY(BlueprintAssignable, Category = "Blu Browser Events")
 	FDownloadUpdatedSignature DownloadUpdated;
 
+	/** Native versions of the events, called before the Blueprint ones and without copying their parameters */
+	FBluDownloadCompleteNative NativeDownloadComplete;
+	FBluDownloadUpdatedNative NativeDownloadUpdated;
+	FBluLogEventNative NativeLogEventEmitter;
+
 	//GENERATED_UCLASS_BODY()
 
 	/** Initialize function, should be called after properties are set */
@@ -65,6 +73,10 @@ public:
 	UFUNCTION(BlueprintCallable, Category = "Blu")
 	void ExecuteJS(const FString& code);
 
+	/** Send any ExecuteJS calls queued by Settings.bBatchJavaScript right away */
+	UFUNCTION(BlueprintCallable, Category = "Blu")
+	void FlushJS();
+
 	/** 
 	 * Execute a JS function/method by name with FString Array as params.
 	 * Each element in the array will be passed into the function in order and separated by a ,
@@ -75,10 +87,188 @@ public:
 	UFUNCTION(BlueprintCallable, Category = "Blu", meta = (DisplayName = "Execute Javascript With Params", Keywords = "js javascript parameters"))
 	void ExecuteJSMethodWithParams(const FString& methodName, const TArray<FString> params);
 
+	/**
+	 * Call a JS function by name (e.g. "app.hud.setHealth") with typed arguments.
+	 * Arguments are passed as values, so strings need no quoting or escaping
+	 */
+	void CallJSFunction(const FString& FunctionName, const TArray<TSharedPtr<FJsonValue>>& Args);
+
+	/** Call a JS function by name, each element of the array is passed as a string argument */
+	UFUNCTION(BlueprintCallable, Category = "Blu", meta = (Keywords = "js javascript call function parameters"))
+	void CallJSFunctionWithStrings(const FString& FunctionName, const TArray<FString>& Args);
+
+	/** Call a JS function by name with a JSON object as its only argument */
+	UFUNCTION(BlueprintCallable, Category = "Blu", meta = (Keywords = "js javascript call function json"))
+	void CallJSFunctionWithJson(const FString& FunctionName, UBluJsonObj* Arg);
+
+	/**
+	 * Run Code in the page and get back its value, or the message of what it threw. Promises are waited on.
+	 * Callback is called exactly once, with TimedOut after TimeoutSeconds (0 waits forever) or Cancelled if the page goes away.
+	 * Returns the request id, for CancelEvaluateJS
+	 */
+	int32 EvaluateJS(const FString& Code, FBluEvaluateCallback Callback, float TimeoutSeconds = 5.f);
+
+	/** Stop waiting on an EvaluateJS call, its callback is called with Cancelled */
+	void CancelEvaluateJS(int32 RequestId);
+
+	/** Run Code in the page and wait for its value. Strings come back as they are, anything else as JSON, and errors as their message */
+	UFUNCTION(BlueprintCallable, Category = "Blu", meta = (Latent, LatentInfo = "LatentInfo", WorldContext = "WorldContextObject", DisplayName = "Evaluate JS", Keywords = "js javascript eval result"))
+	void EvaluateJSLatent(UObject* WorldContextObject, const FString& Code, float TimeoutSeconds, EBluEvaluateStatus& Status, FString& Result, FLatentActionInfo LatentInfo);
+
+	/**
+	 * Answer the page's blui.query(QueryName, payload) calls. Handler gets the query id and payload and
+	 * should call RespondToQuery with that id, now or later. Only one handler per name, a new one replaces the old
+	 */
+	void SetNativeQueryHandler(FName QueryName, FBluNativeQueryHandler Handler);
+
+	/** Answer the page's blui.query(QueryName, payload) calls, respond with RespondToQuery. The payload is JSON unless it was a string */
+	UFUNCTION(BlueprintCallable, Category = "Blu")
+	void SetQueryHandler(FName QueryName, const FBluQueryHandler& Handler);
+
+	/** Stop answering queries with this name, the page's promise will be rejected */
+	UFUNCTION(BlueprintCallable, Category = "Blu")
+	void ClearQueryHandler(FName QueryName);
+
+	/** Resolve a query's promise with Response as a string, or reject it with Response as the error if bSuccess is false */
+	UFUNCTION(BlueprintCallable, Category = "Blu")
+	void RespondToQuery(int32 QueryId, bool bSuccess, const FString& Response);
+
+	/** Resolve a query's promise with a JSON object */
+	UFUNCTION(BlueprintCallable, Category = "Blu")
+	void RespondToQueryWithJson(int32 QueryId, UBluJsonObj* Response);
+
+	/** Resolve or reject a query's promise with any JSON value */
+	void RespondToQueryWithValue(int32 QueryId, bool bSuccess, const TSharedPtr<FJsonValue>& Response);
+
+	/** Is the page still waiting on this query? */
+	UFUNCTION(BlueprintPure, Category = "Blu")
+	bool IsQueryPending(int32 QueryId) const;
+
+	/** Called when the page asking a query went away before it was answered */
+	UPROPERTY(BlueprintAssignable, Category = "Blu Browser Events")
+	FBluQueryCancelledSignature QueryCancelled;
+
+	FBluQueryCancelledNative NativeQueryCancelled;
+
+	/** Send raw bytes to the page's blui.onBulk(Channel) listeners, they get them as an ArrayType (e.g. "Float32Array") */
+	void SendBulkData(FName Channel, const void* Data, int32 NumBytes, const TCHAR* ArrayType = TEXT("Uint8Array"));
+
+	/** Send an array of plain data to the page's blui.onBulk(Channel) listeners as the matching typed array */
+	template<typename T>
+	void SendBulkArray(FName Channel, const TArray<T>& Data)
+	{
+		static_assert(std::is_trivially_copyable<T>::value, "Bulk data is sent as raw bytes, T has to be plain data");
+		SendBulkData(Channel, Data.GetData(), Data.Num() * sizeof(T), TBluTypedArrayName<T>::Get());
+	}
+
+	/** Send JSON to blui.onBulk(Channel) listeners as UTF-8 bytes, written straight into the buffer CEF gets. Decode with TextDecoder and JSON.parse */
+	void SendBulkJson(FName Channel, const FJsonObject& Json);
+
+	/** Send JSON to blui.onMessagePack(Channel) listeners as MessagePack, smaller than JSON text and quicker for the page to decode */
+	UFUNCTION(BlueprintCallable, Category = "Blu")
+	void SendMessagePack(FName Channel, UBluJsonObj* Json);
+
+	void SendMessagePack(FName Channel, const FJsonObject& Json);
+
+	/** Reinterpret bytes received on a bulk channel as an array of T, returns false if the size doesn't fit */
+	template<typename T>
+	static bool BulkDataToArray(const TArray<uint8>& Data, TArray<T>& OutArray)
+	{
+		static_assert(std::is_trivially_copyable<T>::value, "Bulk data is raw bytes, T has to be plain data");
+		if (Data.Num() % sizeof(T) != 0)
+		{
+			return false;
+		}
+
+		OutArray.SetNumUninitialized(Data.Num() / sizeof(T));
+		FMemory::Memcpy(OutArray.GetData(), Data.GetData(), Data.Num());
+		return true;
+	}
+
+	/** Send bytes to the page's blui.onBulk(Channel) listeners as a Uint8Array */
+	UFUNCTION(BlueprintCallable, Category = "Blu")
+	void SendBulkBytes(FName Channel, const TArray<uint8>& Data);
+
+	/** Send floats to the page's blui.onBulk(Channel) listeners as a Float32Array */
+	UFUNCTION(BlueprintCallable, Category = "Blu")
+	void SendBulkFloats(FName Channel, const TArray<float>& Data);
+
+	/** Send integers to the page's blui.onBulk(Channel) listeners as an Int32Array */
+	UFUNCTION(BlueprintCallable, Category = "Blu")
+	void SendBulkInts(FName Channel, const TArray<int32>& Data);
+
+	/** Called with the bytes the page sent through blui.sendBulk(channel, data) */
+	UPROPERTY(BlueprintAssignable, Category = "Blu Browser Events")
+	FBluBulkDataSignature BulkDataReceived;
+
+	FBluBulkDataNative NativeBulkDataReceived;
+
+	/** Mirror Object's Blueprint visible properties into blui.models[ModelName] in the page, each tick only the ones that changed are sent */
+	UFUNCTION(BlueprintCallable, Category = "Blu")
+	void BindModel(FName ModelName, UObject* Object);
+
+	/** Mirror a struct into blui.models[ModelName], Data has to outlive the binding */
+	void BindStructModel(FName ModelName, const UScriptStruct* Struct, const void* Data);
+
+	template<typename T>
+	void BindStructModel(FName ModelName, const T& Data)
+	{
+		BindStructModel(ModelName, T::StaticStruct(), &Data);
+	}
+
+	/** Stop sending changes to blui.models[ModelName], the page keeps the last values */
+	UFUNCTION(BlueprintCallable, Category = "Blu")
+	void UnbindModel(FName ModelName);
+
+	/**
+	 * Keep blui.states[StateName] in the page the same as State. The first call sends it whole,
+	 * later ones only send a JSON patch of what changed since the last call. Call it whenever State has changed
+	 */
+	UFUNCTION(BlueprintCallable, Category = "Blu")
+	void SyncJsonState(FName StateName, UBluJsonObj* State);
+
+	void SyncJsonState(FName StateName, const FJsonObject& State);
+
+	/** Forget a synced state and remove it from the page */
+	UFUNCTION(BlueprintCallable, Category = "Blu")
+	void ClearJsonState(FName StateName);
+
 	/** Load a new URL into the browser */
 	UFUNCTION(BlueprintCallable, Category = "Blu")
 	void LoadURL(const FString& newURL);
 
+	/** Load a URL into a hidden browser, call ActivatePreloaded once it's ready to show it without a blank frame */
+	UFUNCTION(BlueprintCallable, Category = "Blu")
+	void PreloadURL(const FString& NewURL);
+
+	/** Has the preloaded URL finished loading? */
+	UFUNCTION(BlueprintPure, Category = "Blu")
+	bool IsPreloadReady() const;
+
+	/** Swap the preloaded page in as the one feeding our texture. Returns false if it hasn't finished loading yet */
+	UFUNCTION(BlueprintCallable, Category = "Blu")
+	bool ActivatePreloaded();
+
+	/** Close the preloaded browser without showing it */
+	UFUNCTION(BlueprintCallable, Category = "Blu")
+	void DiscardPreloaded();
+
+	/** Called when a preloaded URL has finished loading and can be activated */
+	UPROPERTY(BlueprintAssignable, Category = "Blu Browser Events")
+	FPreloadCompleteSignature PreloadComplete;
+
+	/** JS to run after the page has been reloaded following a render process crash, e.g. to restore state */
+	UFUNCTION(BlueprintCallable, Category = "Blu")
+	void SetCrashRestoreScript(const FString& Script);
+
+	/** Seconds it took to get the page back after the last render process crash */
+	UFUNCTION(BlueprintPure, Category = "Blu")
+	float GetLastRecoveryTime() const;
+
+	/** Called once the page is showing again after a render process crash */
+	UPROPERTY(BlueprintAssignable, Category = "Blu Browser Events")
+	FRenderProcessRecoveredSignature RenderProcessRecovered;
+
 	/** Get the currently loaded URL */
 	UFUNCTION(BlueprintPure, Category = "Blu")
 	FString GetCurrentURL();
@@ -119,14 +309,21 @@ public:
 	UFUNCTION(BlueprintCallable, Category = "Blu")
 	void TriggerRightMouseUp(const FVector2D& pos, const float scale = 1);
 
-	/** Move the mouse in the browser */
+	/** Move the mouse in the browser, only the last move of a frame is sent */
 	UFUNCTION(BlueprintCallable, Category = "Blu")
 	void TriggerMouseMove(const FVector2D& pos, const float scale = 1);
 
-	/** Move the mouse in the browser */
+	/** Scroll the browser, wheel deltas within a frame are added up and sent once */
 	UFUNCTION(BlueprintCallable, Category = "Blu")
 	void TriggerMouseWheel(const float MouseWheelDelta, const FVector2D& pos, const float scale = 1);
 
+	/**
+	 * Queue a frame's worth of input, sent in one go right before CEF pumps its messages.
+	 * Events are sorted by sequence, back to back moves collapse into the last one and back to back wheel events are added up
+	 */
+	UFUNCTION(BlueprintCallable, Category = "Blu")
+	void SubmitInput(const TArray<FBluInputEvent>& Events);
+
 	/** Javascript event emitter */
 	UPROPERTY(BlueprintAssignable)
 	FScriptEvent ScriptEventEmitter;
@@ -134,6 +331,31 @@ public:
 	UPROPERTY(BlueprintAssignable)
 	FLogEvent LogEventEmitter;
 
+	/** Javascript events with their payload as typed values, for C++ listeners */
+	FBluTypedScriptEvent TypedScriptEventEmitter;
+
+	/**
+	 * Call Callback only for Javascript events with this name.
+	 * Names are matched as FNames, so case is ignored: a callback bound to "Update" also gets "update"
+	 */
+	UFUNCTION(BlueprintCallable, Category = "Blu")
+	void BindScriptEvent(FName EventName, const FBluNamedScriptEvent& Callback);
+
+	/** Stop calling Callback for Javascript events with this name */
+	UFUNCTION(BlueprintCallable, Category = "Blu")
+	void UnbindScriptEvent(FName EventName, const FBluNamedScriptEvent& Callback);
+
+	/** Javascript events with this name, for C++ listeners. Like BindScriptEvent, case is ignored */
+	FBluNamedTypedScriptEvent& OnScriptEvent(FName EventName);
+
+	/** How many events had a named subscriber, and how many were skipped because nothing was bound to their name (in any case) */
+	UFUNCTION(BlueprintPure, Category = "Blu")
+	void GetScriptEventStats(int64& Dispatched, int64& Filtered) const;
+
+	/** How many mouse moves and wheel events we were given, and how many were sent on after coalescing */
+	UFUNCTION(BlueprintPure, Category = "Blu")
+	void GetMouseInputStats(int64& MovesReceived, int64& MovesSent, int64& WheelsReceived, int64& WheelsSent) const;
+
 	/** Trigger a key down event */
 	UFUNCTION(BlueprintCallable, Category = "Blu")
 	void KeyDown(FKeyEvent InKey);
@@ -209,12 +431,39 @@ public:
 
 	void TextureUpdate(const void* buffer, FUpdateTextureRegion2D * updateRegions, uint32  regionCount);
 
+	// Called by our browser clients when a browser's main frame starts loading a new page
+	void OnBrowserLoadStart(CefRefPtr<CefBrowser> LoadingBrowser);
+
+	// Called by our browser clients when a browser stops loading
+	void OnBrowserLoadComplete(CefRefPtr<CefBrowser> LoadedBrowser);
+
+	// Called by our browser clients when the page sends an event
+	void DispatchScriptEvent(const FString& EventName, const FBluEventPayload& Payload);
+
+	// Called by our browser clients when the page sends bulk data
+	void DispatchBulkData(FName Channel, const TArray<uint8>& Data);
+
+	// Called by our browser clients for console messages and title changes
+	void DispatchLogMessage(const FString& LogText);
+
+	// Called by our browser clients as downloads progress
+	void DispatchDownloadUpdated(const FString& Url, float Percentage, bool bComplete);
+
+	// Called by our browser clients when a browser's render process goes away
+	void OnRenderProcessTerminated(CefRefPtr<CefBrowser> TerminatedBrowser, int32 Status);
+
 	void BeginDestroy() override;
 
 	/** Use this to pause the tick loop in the new system */
 	UFUNCTION(BlueprintCallable, Category = "Blu")
 	static void SetShouldTickEventLoop(bool ShouldTick = true);
 
+	/** Is the shared CEF message loop currently registered with the ticker? */
+	static bool IsEventLoopTicking();
+
+	/** Tick every eye and then pump the CEF message loop once */
+	static void RunMessageLoop(float DeltaTime);
+
 protected:
 
 	CefWindowInfo Info;
@@ -226,6 +475,144 @@ protected:
 	CefMouseEvent MouseEvent;
 	CefKeyEvent KeyEvent;
 
+	// Mouse input held until the end of the frame, only the latest move and the summed wheel delta are sent
+	bool bPendingMouseMove;
+	bool bPendingMouseWheel;
+	FIntPoint PendingMousePos;
+	FIntPoint PendingWheelPos;
+	float PendingWheelDelta;
+
+	// Whether we've already given the browser focus, so we don't ask again on every move
+	bool bHasFocus;
+
+	int64 MouseMovesReceived;
+	int64 MouseMovesSent;
+	int64 MouseWheelsReceived;
+	int64 MouseWheelsSent;
+
+	// Send held back mouse input, before anything that has to come after it and once a frame
+	void FlushPendingMouse();
+
+	void SendMouseMove(const CefMouseEvent& Event);
+	void SendMouseWheel(const CefMouseEvent& Event, float Delta);
+
+	// Input from SubmitInput waiting for the next tick
+	TArray<FBluInputEvent> SubmittedInput;
+
+	// Sort, collapse and send everything SubmitInput was given since the last tick
+	void DeliverSubmittedInput();
+
+	void SendInputEvent(const FBluInputEvent& Event);
+
+	// Script queued by ExecuteJS while batching
+	FString PendingJS;
+
+	// Per frame work that has to happen before CEF pumps its messages
+	void TickBeforeMessageLoop(float DeltaTime);
+
+	// Named script event subscribers, Blueprint and native
+	TMap<FName, TArray<FBluNamedScriptEvent>> ScriptEventBindings;
+	TMap<FName, FBluNamedTypedScriptEvent> TypedScriptEventBindings;
+
+	int64 ScriptEventsDispatched;
+	int64 ScriptEventsFiltered;
+
+	// Page events held back for async parsing, in the order they came in
+	TArray<FBluQueuedScriptEvent> QueuedScriptEvents;
+
+	// Handle internal events or send one to every eye sharing our browser
+	void HandleScriptEvent(const FString& EventName, const FBluEventPayload& Payload);
+
+	// Hand on queued events whose parsing has finished, stopping at the first that hasn't
+	void DeliverQueuedScriptEvents();
+
+	// Deliver an event to this eye's listeners
+	void DeliverScriptEvent(const FString& EventName, FName InternedName, const FBluEventPayload& Payload);
+
+	// EvaluateJS calls waiting on the page, by request id
+	TMap<int32, FBluPendingEvaluation> PendingEvaluations;
+
+	// Shared by every eye, so ids stay unique when eyes share a browser
+	static int32 NextRequestId;
+
+	// Returns false if the request isn't one of ours
+	bool CompleteEvaluation(int32 RequestId, const FBluEvaluateResult& Result);
+
+	// Time out anything we've waited on for too long
+	void ExpireEvaluations();
+
+	// The page that would answer is gone
+	void CancelAllEvaluations();
+
+	// Query handlers by name, native ones take priority
+	TMap<FName, FBluNativeQueryHandler> NativeQueryHandlers;
+	TMap<FName, FBluQueryHandler> QueryHandlers;
+
+	// Queries waiting on a response, our id to the page's id
+	TMap<int32, int32> PendingQueries;
+
+	bool HasQueryHandler(FName QueryName) const;
+
+	// Hand a query from the page to its handler
+	void StartQuery(int32 PageQueryId, FName QueryName, const TSharedPtr<FJsonValue>& Payload);
+
+	void SendQueryResponse(int32 PageQueryId, bool bSuccess, const TSharedPtr<FJsonValue>& Response);
+
+	void CancelAllQueries();
+
+	// Cancel everything waiting on the current page
+	void CancelPageRequests();
+
+	// Objects and structs mirrored into blui.models
+	TMap<FName, TUniquePtr<FBluModelBinding>> ModelBindings;
+
+	// Send what changed in every bound model as one script
+	void PushModelChanges();
+
+	// Send every field of every model, and every synced JSON state whole, next tick
+	void MarkModelsDirty();
+
+	// What SyncJsonState last sent, by state name
+	TMap<FName, FBluSyncedJsonState> SyncedJsonStates;
+
+	// Send synced states the page has lost
+	void ResendJsonStates();
+
+	// Hidden browser used by PreloadURL
+	CefRefPtr<CefBrowser> PreloadBrowser;
+	CefRefPtr<BrowserClient> PreloadClient;
+	RenderHandler* PreloadRenderer;
+	FString PreloadedURL;
+	bool bPreloadReady;
+
+	// Hidden browser that takes over when the render process crashes
+	CefRefPtr<CefBrowser> StandbyBrowser;
+	CefRefPtr<BrowserClient> StandbyClient;
+	RenderHandler* StandbyRenderer;
+
+	// Last page the active browser finished loading
+	FString LastLoadedURL;
+
+	FString CrashRestoreScript;
+
+	// When the current crash recovery started, 0 if we're not recovering
+	double RecoveryStartTime;
+	float LastRecoveryTime;
+
+	// Install our javascript helpers into a page that finished loading
+	void InjectPageScripts(CefRefPtr<CefBrowser> LoadedBrowser);
+
+	void SpawnStandbyBrowser();
+	void FinishCrashRecovery();
+
+	// Resolve blui:// and devtools urls into something CEF can load
+	FString ResolveURL(const FString& newURL) const;
+
+	CefRefPtr<CefBrowser> CreateBrowserInstance(const FString& InitialURL, RenderHandler*& OutRenderer, CefRefPtr<BrowserClient>& OutClient);
+
+	// Make another browser the one feeding our texture and close the old one
+	void SwapActiveBrowser(CefRefPtr<CefBrowser> NewBrowser, CefRefPtr<BrowserClient> NewClient, RenderHandler* NewRenderer);
+
 	void ResetTexture();
 	void DestroyTexture();
 	void ResetMatInstance();
@@ -240,6 +627,32 @@ protected:
 
 	static FTickEventLoopData EventLoopData;
 
+	// Shared browsers keyed by URL, size and settings
+	static TMap<FString, FBluSharedBrowser> SharedBrowsers;
+
+	// Key into SharedBrowsers, empty if this eye isn't shared
+	FString SharedKey;
+
+	// URL SharedKey was made from, so it can be remade when our size changes
+	FString SharedURL;
+
+	FString MakeSharedKey() const;
+	FString MakeSharedKey(const FString& URL) const;
+
+	// Our shared browser is going to show URL or its size changed, move it to the key eyes wanting that would look for
+	void RekeySharedBrowser(const FString& URL);
+
+	// Returns true if we attached to an existing shared browser, otherwise registers us as its owner
+	bool AttachToSharedBrowser();
+
+	// Returns true if other eyes are still using our browser and texture
+	bool ReleaseSharedBrowser();
+
+	// Take over the browser callbacks, standby browser and crash restore state from a shared owner that is going away
+	void AdoptSharedBrowser(UBluEye* PreviousOwner);
+
+	bool CanSendInput() const;
+
 	// Store UI state in this UTexture2D
 	UPROPERTY()
 	UTexture2D* Texture;
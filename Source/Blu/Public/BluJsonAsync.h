@@ -0,0 +1,28 @@
+#pragma once
+
+#include "CoreMinimal.h"
+#include "Async/Future.h"
+
+class FJsonObject;
+class FJsonValue;
+
+/**
+ * Parse and serialize JSON on the task graph so large payloads don't hold up a frame.
+ * Callbacks are called on the game thread. An object handed to Serialize mustn't be changed until its callback has run.
+ */
+class BLU_API FBluJsonAsync
+{
+public:
+
+	/** Object is null if the string didn't parse */
+	typedef TFunction<void(TSharedPtr<FJsonObject> /*Object*/)> FParseCallback;
+	typedef TFunction<void(FString&& /*JsonString*/)> FSerializeCallback;
+
+	static void Parse(FString JsonString, FParseCallback Callback);
+
+	/** Serialize as condensed JSON */
+	static void Serialize(TSharedPtr<FJsonObject> Object, FSerializeCallback Callback);
+
+	/** Parse any JSON value on the task graph and collect it later, e.g. from a tick. Null if it didn't parse */
+	static TFuture<TSharedPtr<FJsonValue>> ParseValue(FString JsonString);
+};
@@ -0,0 +1,123 @@
+#pragma once
+
+#include "Kismet/BlueprintFunctionLibrary.h"
+#include "Dom/JsonObject.h"
+#include "BluJsonHandle.generated.h"
+
+class UBluJsonObj;
+
+/**
+ * Lightweight reference to a built JSON object. Copies share the same document, so changes through one handle
+ * are seen by every other handle and any UBluJsonObj it came from. Reading through handles creates no UObjects.
+ * Handles can't point into a lazily parsed document, taking one builds the object it refers to.
+ */
+USTRUCT(BlueprintType)
+struct BLU_API FBluJsonHandle
+{
+	GENERATED_BODY()
+
+	FBluJsonHandle() = default;
+
+	explicit FBluJsonHandle(TSharedPtr<FJsonObject> InObject)
+		: Object(MoveTemp(InObject))
+	{
+	}
+
+	bool IsValid() const { return Object.IsValid(); }
+
+	TSharedPtr<FJsonObject> Object;
+};
+
+UCLASS(ClassGroup = Blu)
+class BLU_API UBluJsonHandleLibrary : public UBlueprintFunctionLibrary
+{
+	GENERATED_BODY()
+
+public:
+
+	//// Creating handles ////
+
+	/** Parse a JSON string into a handle, without creating a UObject */
+	UFUNCTION(BlueprintCallable, meta = (DisplayName = "Parse JSON To Handle", Keywords = "blui blu json parse handle"), Category = "Blu|JSON Handle")
+	static FBluJsonHandle ParseJSONToHandle(const FString& JSONString, bool& bSuccess);
+
+	/** An empty object to fill in */
+	UFUNCTION(BlueprintPure, meta = (DisplayName = "Make JSON Handle", Keywords = "blui blu json new create handle"), Category = "Blu|JSON Handle")
+	static FBluJsonHandle MakeJSONHandle();
+
+	/**
+	 * Handle to the same document as a BluJsonObj.
+	 * A lazily parsed BluJsonObj is built in full first. A nested object read lazily from another one was built
+	 * on its own, so its handle doesn't see or change the parent's document
+	 */
+	UFUNCTION(BlueprintPure, meta = (DisplayName = "To JSON Handle", BlueprintAutocast), Category = "Blu|JSON Handle")
+	static FBluJsonHandle ToJSONHandle(UBluJsonObj* JsonObj);
+
+	/** Wrap the handle's document in a BluJsonObj, for functions that need one */
+	UFUNCTION(BlueprintCallable, meta = (DisplayName = "To BluJsonObj"), Category = "Blu|JSON Handle")
+	static UBluJsonObj* ToBluJsonObj(const FBluJsonHandle& Handle);
+
+	UFUNCTION(BlueprintPure, meta = (DisplayName = "Is Valid"), Category = "Blu|JSON Handle")
+	static bool IsValidHandle(const FBluJsonHandle& Handle);
+
+	UFUNCTION(BlueprintPure, meta = (DisplayName = "Handle To String"), Category = "Blu|JSON Handle")
+	static FString HandleToString(const FBluJsonHandle& Handle);
+
+	//// Get Values ////
+
+	UFUNCTION(BlueprintPure, Category = "Blu|JSON Handle")
+	static bool HasField(const FBluJsonHandle& Handle, const FString& Index);
+
+	UFUNCTION(BlueprintPure, Category = "Blu|JSON Handle")
+	static FString GetStringValue(const FBluJsonHandle& Handle, const FString& Index);
+
+	UFUNCTION(BlueprintPure, Category = "Blu|JSON Handle")
+	static float GetNumValue(const FBluJsonHandle& Handle, const FString& Index);
+
+	UFUNCTION(BlueprintPure, Category = "Blu|JSON Handle")
+	static bool GetBooleanValue(const FBluJsonHandle& Handle, const FString& Index);
+
+	/** Handle to a nested object, shares the document. Invalid if there's no object under Index */
+	UFUNCTION(BlueprintPure, Category = "Blu|JSON Handle")
+	static FBluJsonHandle GetNestedObject(const FBluJsonHandle& Handle, const FString& Index);
+
+	//// Get Array Values ////
+
+	UFUNCTION(BlueprintPure, Category = "Blu|JSON Handle")
+	static TArray<float> GetNumArray(const FBluJsonHandle& Handle, const FString& Index);
+
+	UFUNCTION(BlueprintPure, Category = "Blu|JSON Handle")
+	static TArray<bool> GetBooleanArray(const FBluJsonHandle& Handle, const FString& Index);
+
+	UFUNCTION(BlueprintPure, Category = "Blu|JSON Handle")
+	static TArray<FString> GetStringArray(const FBluJsonHandle& Handle, const FString& Index);
+
+	UFUNCTION(BlueprintPure, Category = "Blu|JSON Handle")
+	static TArray<FBluJsonHandle> GetObjectArray(const FBluJsonHandle& Handle, const FString& Index);
+
+	//// Set Values ////
+
+	UFUNCTION(BlueprintCallable, Category = "Blu|JSON Handle")
+	static void SetStringValue(const FBluJsonHandle& Handle, const FString& Value, const FString& Index);
+
+	UFUNCTION(BlueprintCallable, Category = "Blu|JSON Handle")
+	static void SetNumValue(const FBluJsonHandle& Handle, const float Value, const FString& Index);
+
+	UFUNCTION(BlueprintCallable, Category = "Blu|JSON Handle")
+	static void SetBooleanValue(const FBluJsonHandle& Handle, const bool Value, const FString& Index);
+
+	UFUNCTION(BlueprintCallable, Category = "Blu|JSON Handle")
+	static void SetNestedObject(const FBluJsonHandle& Handle, const FBluJsonHandle& Value, const FString& Index);
+
+	UFUNCTION(BlueprintCallable, Category = "Blu|JSON Handle")
+	static void SetStringArray(const FBluJsonHandle& Handle, const TArray<FString>& Value, const FString& Index);
+
+	UFUNCTION(BlueprintCallable, Category = "Blu|JSON Handle")
+	static void SetBooleanArray(const FBluJsonHandle& Handle, const TArray<bool>& Value, const FString& Index);
+
+	UFUNCTION(BlueprintCallable, Category = "Blu|JSON Handle")
+	static void SetNumArray(const FBluJsonHandle& Handle, const TArray<float>& Value, const FString& Index);
+
+	UFUNCTION(BlueprintCallable, Category = "Blu|JSON Handle")
+	static void SetObjectArray(const FBluJsonHandle& Handle, const TArray<FBluJsonHandle>& Value, const FString& Index);
+};
@@ -1,5 +1,6 @@
 #pragma once
 
+#include "BluJsonTape.h"
 #include "BluJsonObj.generated.h"
 
 UCLASS(ClassGroup = Blu, Blueprintable)
@@ -60,10 +61,65 @@ public:
 	UFUNCTION(BlueprintCallable, Category = "Blu")
 	void SetNestedObject(UBluJsonObj *Value, const FString &Index);
 
+	//// Structs ////
+
+	/**
+	 * Fill any struct from this object in one go, nested structs and arrays included.
+	 * Fields are matched to properties by name, ignoring case. Returns false if a field couldn't be converted
+	 */
+	UFUNCTION(BlueprintCallable, CustomThunk, meta = (DisplayName = "To Struct", CustomStructureParam = "OutStruct"), Category = "Blu")
+	bool K2_ToStruct(int32& OutStruct);
+
+	/** Replace this object's fields with a struct's properties, nested structs and arrays included */
+	UFUNCTION(BlueprintCallable, CustomThunk, meta = (DisplayName = "From Struct", CustomStructureParam = "Struct"), Category = "Blu")
+	bool K2_FromStruct(const int32& Struct);
+
+	bool ToStruct(const UScriptStruct* Struct, void* OutStruct);
+	bool FromStruct(const UScriptStruct* Struct, const void* Data);
+
+	template<typename T>
+	bool ToStruct(T& OutStruct)
+	{
+		return ToStruct(T::StaticStruct(), &OutStruct);
+	}
+
+	template<typename T>
+	bool FromStruct(const T& Struct)
+	{
+		return FromStruct(T::StaticStruct(), &Struct);
+	}
+
+	DECLARE_FUNCTION(execK2_ToStruct);
+	DECLARE_FUNCTION(execK2_FromStruct);
+
+	//// MessagePack ////
+
+	/** This object as MessagePack, a compact binary form of JSON */
+	UFUNCTION(BlueprintCallable, Category = "Blu")
+	TArray<uint8> ToMessagePack();
+
+	/** Replace this object with MessagePack that holds a map, e.g. bytes from blui.sendMessagePack. Left as it was if it doesn't */
+	UFUNCTION(BlueprintCallable, Category = "Blu")
+	bool FromMessagePack(const TArray<uint8>& Data);
+
+	/** Appends to Out */
+	void ToMessagePack(TArray<uint8>& Out);
+
 	void Init(const FString &dataString);
+
+	/**
+	 * Index the JSON without building it, values are only decoded when they're read.
+	 * Setting anything builds it in full, nested objects read lazily are built separately from their parent
+	 */
+	void InitLazy(const FString &DataString);
+	void InitLazy(const ANSICHAR* Utf8Data, int32 Length);
+
 	void SetJsonObj(TSharedPtr<FJsonObject> NewJson);
 	
 	TSharedPtr<FJsonObject> GetJsonObj();
+
+	/** The lazy document and where this object is in it, null if the object has been built in full */
+	const FBluJsonTape* GetLazyTape(int32& OutIndex) const;
 	
 	// CUSTOM ADDED START
 	UFUNCTION(BlueprintCallable, Category = "Blu")
@@ -84,5 +140,17 @@ private:
 	FString StrData;
 	TSharedPtr<FJsonObject> JsonParsed;
 
+	// Lazy backend, used instead of JsonParsed until something needs the full object
+	TSharedPtr<const FBluJsonTape> Tape;
+	int32 TapeIndex;
+
 	void DoParseJson(TSharedRef<TJsonReader<TCHAR>> JsonReader);
+
+	void SetTape(TSharedPtr<const FBluJsonTape> NewTape, int32 Index);
+
+	// Value of a field in the lazy document, InvalidIndex if it isn't there
+	int32 FindTapeField(const FString &Index) const;
+
+	// Build JsonParsed from the lazy document so it can be changed or handed out
+	void MaterializeTape();
 };
\ No newline at end of file
@@ -0,0 +1,35 @@
+#pragma once
+
+#include "CoreMinimal.h"
+#include "Dom/JsonObject.h"
+
+/**
+ * RFC 6902 JSON patches, so a large document can be kept in sync by sending only what changed.
+ * Paths are JSON pointers like "/players/3/hp".
+ */
+class BLU_API FBluJsonPatch
+{
+public:
+
+	/** Operations that turn From into To. Only add, remove and replace are generated, arrays are compared index by index */
+	static TArray<TSharedPtr<FJsonValue>> Diff(const FJsonObject& From, const FJsonObject& To);
+
+	/**
+	 * Apply add, remove, replace, move, copy and test operations in order. Values are copied in, so Target never shares them with the patch.
+	 * Stops at the first one that fails and leaves the operations before it applied
+	 */
+	static bool Apply(FJsonObject& Target, const TArray<TSharedPtr<FJsonValue>>& Patch, FString* OutError = nullptr);
+
+	/** Condensed JSON for a patch */
+	static FString ToString(const TArray<TSharedPtr<FJsonValue>>& Patch);
+
+	/** Deep copy of objects and arrays. Strings, numbers and the like are never changed in place, so they're shared */
+	static TSharedPtr<FJsonValue> Clone(const TSharedPtr<FJsonValue>& Value);
+	static TSharedRef<FJsonObject> CloneObject(const FJsonObject& Object);
+
+	/** Deep comparison, object fields can be in any order */
+	static bool Equals(const TSharedPtr<FJsonValue>& A, const TSharedPtr<FJsonValue>& B);
+
+	/** Escape an object key for use in a path, "~" becomes "~0" and "/" becomes "~1" */
+	static FString EscapePathToken(const FString& Key);
+};
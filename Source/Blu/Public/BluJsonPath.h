@@ -0,0 +1,161 @@
+#pragma once
+
+#include "Kismet/BlueprintFunctionLibrary.h"
+#include "Dom/JsonObject.h"
+#include "BluJsonHandle.h"
+#include "BluJsonPath.generated.h"
+
+class FBluJsonTape;
+class UBluJsonObj;
+
+/**
+ * A path like "a.b.c[3]" compiled once so it can be looked up over and over.
+ * Keys are split and hashed up front, evaluating only walks the document and allocates nothing.
+ */
+USTRUCT(BlueprintType)
+struct BLU_API FBluJsonPath
+{
+	GENERATED_BODY()
+
+	struct FSegment
+	{
+		FString Key;
+		uint32 KeyHash = 0;
+
+		// Same key as UTF-8, for lazy documents
+		TArray<ANSICHAR> Utf8Key;
+
+		// Element to take from an array, INDEX_NONE if this segment is a key
+		int32 ArrayIndex = INDEX_NONE;
+
+		bool IsKey() const { return ArrayIndex == INDEX_NONE; }
+
+		bool Matches(const FSegment& Other) const;
+	};
+
+	/** Compile a path, e.g. "hud.players[2].name". OutError says what's wrong with it if it can't be compiled */
+	static FBluJsonPath Compile(const FString& InPath, FString* OutError = nullptr);
+
+	bool IsValid() const { return Segments.Num() > 0; }
+
+	/** Value at the path, null if any step along it is missing. Points into the document */
+	const TSharedPtr<FJsonValue>* Find(const FJsonObject& Root) const;
+
+	/** Value at the path in a lazy document, FBluJsonTape::InvalidIndex if any step along it is missing */
+	int32 Find(const FBluJsonTape& Tape, int32 RootIndex) const;
+
+	/** Take one step into a value */
+	static const TSharedPtr<FJsonValue>* Step(const TSharedPtr<FJsonValue>& Value, const FSegment& Segment);
+	static const TSharedPtr<FJsonValue>* Step(const FJsonObject& Object, const FSegment& Segment);
+	static int32 Step(const FBluJsonTape& Tape, int32 Index, const FSegment& Segment);
+
+	/** The path this was compiled from */
+	UPROPERTY(VisibleAnywhere, BlueprintReadOnly, Category = "Blu|JSON Path")
+	FString Path;
+
+	// Not saved, rebuilt from Path when loaded
+	TArray<FSegment> Segments;
+
+	void PostSerialize(const FArchive& Ar);
+};
+
+template<>
+struct TStructOpsTypeTraits<FBluJsonPath> : public TStructOpsTypeTraitsBase2<FBluJsonPath>
+{
+	enum
+	{
+		WithPostSerialize = true
+	};
+};
+
+/**
+ * Fills fields of a struct from a set of precompiled paths in one walk over the document.
+ * Paths sharing a prefix, like "player.stats.hp" and "player.stats.mp", only look the prefix up once.
+ */
+class BLU_API FBluJsonStructPaths
+{
+public:
+
+	/** Map each field of Struct to the path its value comes from */
+	bool Compile(const UScriptStruct* InStruct, const TMap<FName, FString>& FieldPaths, FString* OutError = nullptr);
+
+	template<typename T>
+	bool Compile(const TMap<FName, FString>& FieldPaths, FString* OutError = nullptr)
+	{
+		return Compile(T::StaticStruct(), FieldPaths, OutError);
+	}
+
+	/** Fill the fields whose paths exist in Root, returns how many were filled. Other fields are left as they were */
+	int32 Extract(const FJsonObject& Root, void* OutStruct) const;
+
+	template<typename T>
+	int32 Extract(const FJsonObject& Root, T& OutStruct) const
+	{
+		check(T::StaticStruct() == Struct);
+		return Extract(Root, &OutStruct);
+	}
+
+	/** Same for a lazy document, only the values that end up in a field are built */
+	int32 Extract(const FBluJsonTape& Tape, int32 RootIndex, void* OutStruct) const;
+
+	template<typename T>
+	int32 Extract(const FBluJsonTape& Tape, int32 RootIndex, T& OutStruct) const
+	{
+		check(T::StaticStruct() == Struct);
+		return Extract(Tape, RootIndex, &OutStruct);
+	}
+
+private:
+
+	struct FNode
+	{
+		FBluJsonPath::FSegment Segment;
+		TArray<int32> Children;
+
+		// Fields that take the value at this node
+		TArray<FProperty*> Properties;
+	};
+
+	// Node 0 is the root object
+	TArray<FNode> Nodes;
+	const UScriptStruct* Struct = nullptr;
+
+	void ExtractNode(const FNode& Node, const TSharedPtr<FJsonValue>& Value, void* OutStruct, int32& Filled) const;
+	void ExtractNode(const FNode& Node, const FBluJsonTape& Tape, int32 Index, void* OutStruct, int32& Filled) const;
+};
+
+UCLASS(ClassGroup = Blu)
+class BLU_API UBluJsonPathLibrary : public UBlueprintFunctionLibrary
+{
+	GENERATED_BODY()
+
+public:
+
+	/** Compile a path like "a.b.c[3]" once, keep it in a variable and use it with the Get ... At Path functions */
+	UFUNCTION(BlueprintPure, meta = (DisplayName = "Compile JSON Path", Keywords = "blui blu json path query"), Category = "Blu|JSON Path")
+	static FBluJsonPath CompileJsonPath(const FString& Path, bool& bSuccess);
+
+	UFUNCTION(BlueprintPure, Category = "Blu|JSON Path")
+	static bool GetNumberAtPath(UBluJsonObj* JsonObj, const FBluJsonPath& Path, float& Value);
+
+	UFUNCTION(BlueprintPure, Category = "Blu|JSON Path")
+	static bool GetStringAtPath(UBluJsonObj* JsonObj, const FBluJsonPath& Path, FString& Value);
+
+	UFUNCTION(BlueprintPure, Category = "Blu|JSON Path")
+	static bool GetBooleanAtPath(UBluJsonObj* JsonObj, const FBluJsonPath& Path, bool& Value);
+
+	UFUNCTION(BlueprintPure, Category = "Blu|JSON Path")
+	static bool GetNumArrayAtPath(UBluJsonObj* JsonObj, const FBluJsonPath& Path, TArray<float>& Value);
+
+	/** Handle to the object at the path. Shares the document, unless it's lazy and only the object at the path gets built */
+	UFUNCTION(BlueprintPure, Category = "Blu|JSON Path")
+	static bool GetObjectAtPath(UBluJsonObj* JsonObj, const FBluJsonPath& Path, FBluJsonHandle& Value);
+
+	/** Number at each path, 0 where it's missing */
+	UFUNCTION(BlueprintPure, Category = "Blu|JSON Path")
+	static TArray<float> GetNumbersAtPaths(UBluJsonObj* JsonObj, const TArray<FBluJsonPath>& Paths);
+
+	/** String at each path, empty where it's missing */
+	UFUNCTION(BlueprintPure, Category = "Blu|JSON Path")
+	static TArray<FString> GetStringsAtPaths(UBluJsonObj* JsonObj, const TArray<FBluJsonPath>& Paths);
+};
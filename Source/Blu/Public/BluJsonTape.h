@@ -0,0 +1,120 @@
+#pragma once
+
+#include "CoreMinimal.h"
+
+class FJsonValue;
+class FJsonObject;
+
+/**
+ * Flat index over a UTF-8 JSON document.
+ * Parsing only records the type, position and extent of every value in one array (the tape), nothing is
+ * decoded or allocated per value. Strings and numbers are decoded from the original bytes when they're read,
+ * so pulling a couple of fields out of a large payload only pays for those fields.
+ */
+class BLU_API FBluJsonTape
+{
+public:
+
+	enum class EType : uint8
+	{
+		Null,
+		False,
+		True,
+		Number,
+		String,
+		Object,
+		Array
+	};
+
+	/** Index of the root value */
+	static constexpr int32 RootIndex = 0;
+
+	/** Returned when a field or element doesn't exist */
+	static constexpr int32 InvalidIndex = INDEX_NONE;
+
+	/** Parse UTF-8 text, the tape keeps its own copy */
+	bool Parse(TArray<uint8>&& Utf8Document);
+	bool Parse(const ANSICHAR* Utf8Data, int32 Length);
+
+	/** Convert to UTF-8 and parse */
+	bool Parse(const FString& Document);
+
+	bool IsValid() const { return Entries.Num() > 0; }
+
+	EType GetType(int32 Index) const { return Entries[Index].Type; }
+
+	/**
+	 * Value of Key in the object at ObjectIndex, InvalidIndex if it isn't there.
+	 * Matches FJsonObject: keys compare without regard to ASCII case and the last of duplicate keys wins
+	 */
+	int32 FindField(int32 ObjectIndex, const FString& Key) const;
+
+	/** Same as FindField with a key that's already UTF-8, for lookups done over and over */
+	int32 FindFieldUtf8(int32 ObjectIndex, const ANSICHAR* Key, int32 KeyLength) const;
+
+	/** Element at ElementIndex of the array at ArrayIndex, InvalidIndex if it's out of range */
+	int32 GetArrayElement(int32 ArrayIndex, int32 ElementIndex) const;
+
+	/** Number of elements in an array or fields in an object */
+	int32 GetCount(int32 Index) const { return Entries[Index].Count; }
+
+	/** First element of an array or first key of an object, InvalidIndex if it's empty */
+	int32 GetFirstChild(int32 Index) const;
+
+	/** Value following Index in its container, for objects the key and value are separate entries */
+	int32 GetNextSibling(int32 Index) const { return Entries[Index].Next; }
+
+	/** Indices of every element of an array */
+	void GetArrayElements(int32 ArrayIndex, TArray<int32>& OutElements) const;
+
+	bool GetBool(int32 Index) const;
+	double GetNumber(int32 Index) const;
+	FString GetString(int32 Index) const;
+
+	/** Build regular Json values for this part of the document */
+	TSharedPtr<FJsonValue> ToJsonValue(int32 Index) const;
+	TSharedPtr<FJsonObject> ToJsonObject(int32 Index) const;
+
+	/** Bytes of the document this tape indexes */
+	int32 GetDocumentSize() const { return Document.Num(); }
+
+private:
+
+	struct FEntry
+	{
+		// Byte range in Document, for strings without the quotes
+		uint32 Offset;
+		uint32 Length;
+
+		// Entry after this value and everything inside it, InvalidIndex past the end of the parent
+		int32 Next;
+
+		// Children of containers
+		int32 Count;
+
+		EType Type;
+
+		// Strings that need unescaping when read
+		bool bEscaped;
+	};
+
+	TArray<uint8> Document;
+	TArray<FEntry> Entries;
+
+	// Parse state
+	int32 Cursor = 0;
+	int32 Depth = 0;
+
+	// Deeper documents are rejected instead of overflowing the stack
+	static constexpr int32 MaxDepth = 512;
+
+	bool ParseDocument();
+	bool ParseValue();
+	bool ParseString();
+	bool ParseNumber();
+	bool ParseLiteral(const char* Literal, EType Type);
+	bool ParseContainer(bool bObject);
+	void SkipWhitespace();
+
+	bool KeyEquals(int32 KeyIndex, const ANSICHAR* Key, int32 KeyLength) const;
+};
@@ -0,0 +1,77 @@
+#pragma once
+
+#include "CoreMinimal.h"
+
+class FJsonObject;
+class FJsonValue;
+
+/**
+ * Condensed JSON writer that appends straight to a character buffer, TCHAR or UTF-8.
+ * Arrays of plain values can be written from their TArray without making a FJsonValue per element.
+ * Output is safe to paste into a script, U+2028 and U+2029 are escaped.
+ */
+template<typename CharType>
+class BLU_API TBluJsonWriter
+{
+public:
+
+	/** Appends to Out, anything already in it is left alone */
+	explicit TBluJsonWriter(TArray<CharType>& InOut);
+
+	void BeginObject();
+	void EndObject();
+	void BeginArray();
+	void EndArray();
+
+	/** Key of the next value in an object */
+	void WriteKey(const FString& Key);
+
+	void WriteNull();
+	void WriteBool(bool Value);
+	void WriteNumber(double Value);
+	void WriteNumber(float Value);
+	void WriteString(const FString& Value);
+
+	void WriteArray(const TArray<float>& Values);
+	void WriteArray(const TArray<double>& Values);
+	void WriteArray(const TArray<int32>& Values);
+	void WriteArray(const TArray<bool>& Values);
+	void WriteArray(const TArray<FString>& Values);
+
+	void WriteValue(const TSharedPtr<FJsonValue>& Value);
+	void WriteObject(const FJsonObject& Object);
+
+	/** A buffer kept by the calling thread so repeated writes don't allocate, empty when it's handed out */
+	static TArray<CharType>& GetThreadBuffer();
+
+	/** Hand the thread buffer back, it's let go of if it grew very large */
+	static void ReleaseThreadBuffer(TArray<CharType>& Buffer);
+
+private:
+
+	TArray<CharType>& Out;
+
+	// Where we started in Out, nothing before it needs a separator
+	int32 Start;
+
+	// Comma before a value or key that isn't the first in its container
+	void Separate();
+
+	void AppendAscii(const ANSICHAR* Text, int32 Length);
+	void AppendText(const TCHAR* Text, int32 Length);
+	void WriteEscaped(const TCHAR* Text, int32 Length);
+};
+
+typedef TBluJsonWriter<TCHAR> FBluJsonWriter;
+typedef TBluJsonWriter<ANSICHAR> FBluJsonUtf8Writer;
+
+/** One call helpers on top of the writers, using the calling thread's buffer */
+struct BLU_API FBluJson
+{
+	static FString ToString(const FJsonObject& Object);
+	static FString ToString(const TSharedPtr<FJsonValue>& Value);
+	static FString ToString(const TArray<TSharedPtr<FJsonValue>>& Values);
+
+	/** UTF-8 for when the bytes are headed straight to CEF, e.g. over the bulk channel */
+	static void ToUtf8(const FJsonObject& Object, TArray<ANSICHAR>& Out);
+};
@@ -2,6 +2,17 @@
 
 #include "CEFInclude.h"
 
+struct FBluRenderProfile
+{
+	FString Name;
+
+	// Command line switches, either "switch" or "switch=value"
+	TArray<FString> Switches;
+
+	// Does this profile turn off GPU rendering (no WebGL/CSS3)?
+	bool bSoftwareRendering;
+};
+
 class BLU_API BluManager : public CefApp
 {
 public:
@@ -14,6 +25,24 @@ public:
 	static bool CPURenderSettings;
 	static bool AutoPlay;
 
+	/**
+	 * Does the render process handle BLUI's structured messages? Set bStructuredRendererMessages in the [BLUI] game config.
+	 * "blu_call" [function name, list of arguments]: look the function up on window and call it with the arguments as V8 values
+	 * "blu_bulk" [channel, typed array name, binary]: call blui.__receiveBulkBuffer(channel, type, ArrayBuffer) with the bytes copied straight in.
+	 *   The render process may send "blu_bulk" [channel, binary] back the same way
+	 * When off, the same calls are sent as script with the arguments written out as JSON
+	 */
+	static bool bStructuredRendererMessages;
+
+	/** Profile picked by SelectRenderProfile, its switches are applied when CEF starts */
+	static FBluRenderProfile RenderProfile;
+
+	/** Built in profiles plus any defined in the [BLUI] section of the game config */
+	static TArray<FBluRenderProfile> GetRenderProfiles();
+
+	/** Pick the render profile from -BluRenderProfile=, config or a previous benchmark, must run before CefInitialize */
+	static void SelectRenderProfile();
+
 	virtual void OnBeforeCommandLineProcessing(const CefString& ProcessType,
 			CefRefPtr< CefCommandLine > CommandLine) override;
 
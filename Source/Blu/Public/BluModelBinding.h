@@ -0,0 +1,59 @@
+#pragma once
+
+#include "CoreMinimal.h"
+#include "UObject/WeakObjectPtr.h"
+#include "BluJsonWriter.h"
+
+/**
+ * Keeps a snapshot of the Blueprint visible properties of a UObject or struct bound to a JS model.
+ * Each tick the live values are compared against the snapshot, and only the ones that changed are sent to the page.
+ */
+class BLU_API FBluModelBinding
+{
+public:
+
+	explicit FBluModelBinding(UObject* InObject);
+
+	/** StructData isn't owned, it has to outlive the binding */
+	FBluModelBinding(const UScriptStruct* InStruct, const void* InStructData);
+
+	~FBluModelBinding();
+
+	FBluModelBinding(const FBluModelBinding&) = delete;
+	FBluModelBinding& operator=(const FBluModelBinding&) = delete;
+
+	/** False once a bound object has been destroyed */
+	bool IsValid() const;
+
+	/**
+	 * Write every field that changed since the last call as keys of the object Writer is in, and update the snapshot.
+	 * Returns false if nothing changed
+	 */
+	bool CollectChanges(FBluJsonWriter& Writer);
+
+	/** Send every field next time, e.g. after the page has reloaded and lost its model */
+	void MarkAllDirty();
+
+private:
+
+	struct FBoundField
+	{
+		FProperty* Property;
+		int32 SnapshotOffset;
+		FString JsonName;
+	};
+
+	void BuildFields(const UStruct* Struct);
+
+	const void* GetContainer() const;
+
+	TWeakObjectPtr<UObject> Object;
+	const void* StructData;
+
+	TArray<FBoundField> Fields;
+
+	// Last values we sent, laid out back to back for every field
+	uint8* Snapshot;
+
+	bool bSendAll;
+};
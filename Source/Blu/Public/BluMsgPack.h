@@ -0,0 +1,31 @@
+#pragma once
+
+#include "CoreMinimal.h"
+
+class FJsonObject;
+class FJsonValue;
+
+/**
+ * MessagePack encoding of JSON values, smaller than JSON text and quicker to read on both sides.
+ * Whole numbers are written as the smallest integer that holds them, others as float32 when that's exact.
+ * Decoding turns binary into base64 strings and extension types into null, integers past 2^53 lose precision.
+ */
+class BLU_API FBluMsgPack
+{
+public:
+
+	/** Appends to Out */
+	static void Encode(const FJsonObject& Object, TArray<uint8>& Out);
+	static void EncodeValue(const TSharedPtr<FJsonValue>& Value, TArray<uint8>& Out);
+
+	/** Null if the data isn't valid MessagePack or has anything after the value */
+	static TSharedPtr<FJsonValue> DecodeValue(const uint8* Data, int32 NumBytes);
+
+	/** Null unless the data holds a map */
+	static TSharedPtr<FJsonObject> Decode(const uint8* Data, int32 NumBytes);
+
+	static TSharedPtr<FJsonObject> Decode(const TArray<uint8>& Data)
+	{
+		return Decode(Data.GetData(), Data.Num());
+	}
+};
@@ -0,0 +1,58 @@
+#pragma once
+
+#include "CEFInclude.h"
+#include "Containers/Ticker.h"
+
+class BenchmarkClient;
+
+/**
+ * Optional micro-benchmark that picks the fastest render profile for this machine.
+ * CEF switches are fixed once CEF starts, so each launch measures the profile it runs with
+ * and asks the next launch to use a profile that hasn't been measured yet. Once every profile
+ * has a result the fastest one is persisted and used from then on.
+ * Each frame is timed from the begin frame we send to its paint, the game thread waits on it while measuring.
+ *
+ * Enable with bRunRenderBenchmark=True in the [BLUI] section of the game config or -BluRenderBenchmark.
+ */
+class BLU_API FBluRenderBenchmark
+{
+public:
+
+	/** Is the benchmark turned on for this project? */
+	static bool IsEnabled();
+
+	/** Start measuring the active profile if it's enabled and hasn't been measured yet */
+	static void StartIfNeeded();
+
+	/** Profile this launch should use, empty if there's no preference */
+	static FString GetProfileToUse();
+
+	/** Average render time per frame in ms for each profile measured so far */
+	static TMap<FString, float> GetResults();
+
+private:
+
+	static bool Tick(float DeltaTime);
+	static void MeasureFrame();
+	static void Finish();
+
+	static CefRefPtr<BenchmarkClient> Client;
+	static CefRefPtr<CefBrowser> Browser;
+	static FTSTicker::FDelegateHandle TickerHandle;
+	static double StartTime;
+
+	// Milliseconds from sending each begin frame to its paint
+	static TArray<double> FrameTimes;
+	static bool bHasRun;
+
+	// Frames to wait for the page to settle, then frames to measure
+	static constexpr int32 WarmupFrames = 30;
+	static constexpr int32 SampleFrames = 240;
+	static constexpr double TimeoutSeconds = 20.0;
+
+	// Longest we wait on one frame
+	static constexpr double MaxFrameSeconds = 0.25;
+
+	// How much faster than an earlier profile a later one has to be to replace it
+	static constexpr float RequiredMargin = 0.1f;
+};
@@ -0,0 +1,48 @@
+#pragma once
+
+#include "CEFInclude.h"
+#include "Containers/Ticker.h"
+
+class BrowserClient;
+
+/**
+ * Takes ownership of browsers that are being closed, so a BluEye can go away without waiting on CEF.
+ * Closes queued during a frame are issued together on the next tick, and the CEF message loop
+ * keeps being pumped until every browser has reported OnBeforeClose.
+ */
+class BLU_API FBluTeardownManager
+{
+public:
+
+	/** Detach the browser from its BluEye and close it on the next tick */
+	static void QueueClose(CefRefPtr<CefBrowser> Browser, CefRefPtr<BrowserClient> Client);
+
+	/** Called by BrowserClient once CEF has finished closing a browser */
+	static void NotifyClosed(int32 BrowserId);
+
+	/** Are there browsers still waiting to be closed? */
+	static bool HasPendingCloses();
+
+private:
+
+	struct FClosingBrowser
+	{
+		CefRefPtr<CefBrowser> Browser;
+		CefRefPtr<BrowserClient> Client;
+		double CloseRequestTime;
+		bool bClosed;
+	};
+
+	static bool Tick(float DeltaTime);
+
+	// Closes queued this frame
+	static TArray<FClosingBrowser> QueuedCloses;
+
+	// Closes issued to CEF, waiting on OnBeforeClose
+	static TArray<FClosingBrowser> ActiveCloses;
+
+	static FTSTicker::FDelegateHandle TickerHandle;
+
+	// Give up on a browser if CEF hasn't closed it by then
+	static constexpr double CloseTimeoutSeconds = 10.0;
+};
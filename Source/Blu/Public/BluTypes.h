@@ -1,22 +1,34 @@
 #pragma once
 
 #include "CoreMinimal.h"
+#include "Async/Future.h"
 #include "BluTypes.generated.h"
 
+class UBluEye;
+class FJsonValue;
+class FJsonObject;
+
 struct FTickEventLoopData
 {
 	FTSTicker::FDelegateHandle DelegateHandle;
-	int32 EyeCount;
+
+	// Initialized eyes, ticked right before the CEF message loop runs
+	TArray<UBluEye*> Eyes;
 	bool bShouldTickEventLoop;
 
 	FTickEventLoopData()
 	{
 		DelegateHandle = FTSTicker::FDelegateHandle();
-		EyeCount = 0;
 		bShouldTickEventLoop = true;
 	}
 };
 
+struct FBluSharedBrowser
+{
+	// Eyes using this browser, the first one owns the browser and texture
+	TArray<UBluEye*> Eyes;
+};
+
 struct FBluTextureParams
 {
 	// Pointer to our Texture's resource
@@ -57,6 +69,168 @@ enum EBluSpecialKeys
 };
 
 
+enum class EBluEventValueType : uint8
+{
+	None,
+	Bool,
+	Int,
+	Double,
+	String,
+	List,
+	Dictionary,
+	Binary
+};
+
+/** Payload of a script event, kept in the type the render process sent it as */
+struct BLU_API FBluEventPayload
+{
+	EBluEventValueType Type = EBluEventValueType::None;
+
+	bool BoolValue = false;
+	int32 IntValue = 0;
+	double DoubleValue = 0.0;
+	FString StringValue;
+
+	// Lists and dictionaries, nested values keep their types
+	TSharedPtr<FJsonValue> StructuredValue;
+
+	TArray<uint8> BinaryValue;
+
+	/** String form used by the Blueprint script event, lists and dictionaries become JSON and binary becomes base64 */
+	FString ToString() const;
+};
+
+UENUM(BlueprintType)
+enum class EBluEvaluateStatus : uint8
+{
+	Success,
+	Exception UMETA(DisplayName = "Threw Exception"),
+	TimedOut UMETA(DisplayName = "Timed Out"),
+	Cancelled
+};
+
+/** What an EvaluateJS call came back with */
+struct BLU_API FBluEvaluateResult
+{
+	EBluEvaluateStatus Status = EBluEvaluateStatus::Cancelled;
+
+	// The script's value, null for undefined or if it didn't succeed
+	TSharedPtr<FJsonValue> Value;
+
+	// The exception's message when it threw
+	FString Error;
+};
+
+typedef TFunction<void(const FBluEvaluateResult& /*Result*/)> FBluEvaluateCallback;
+
+/** Typed array a bulk array of T shows up as in the page, anything without its own type is sent as bytes */
+template<typename T> struct TBluTypedArrayName { static const TCHAR* Get() { return TEXT("Uint8Array"); } };
+template<> struct TBluTypedArrayName<int8> { static const TCHAR* Get() { return TEXT("Int8Array"); } };
+template<> struct TBluTypedArrayName<int16> { static const TCHAR* Get() { return TEXT("Int16Array"); } };
+template<> struct TBluTypedArrayName<uint16> { static const TCHAR* Get() { return TEXT("Uint16Array"); } };
+template<> struct TBluTypedArrayName<int32> { static const TCHAR* Get() { return TEXT("Int32Array"); } };
+template<> struct TBluTypedArrayName<uint32> { static const TCHAR* Get() { return TEXT("Uint32Array"); } };
+template<> struct TBluTypedArrayName<float> { static const TCHAR* Get() { return TEXT("Float32Array"); } };
+template<> struct TBluTypedArrayName<double> { static const TCHAR* Get() { return TEXT("Float64Array"); } };
+
+typedef TFunction<void(int32 /*QueryId*/, const TSharedPtr<FJsonValue>& /*Payload*/)> FBluNativeQueryHandler;
+
+struct FBluPendingEvaluation
+{
+	FBluEvaluateCallback Callback;
+
+	// FPlatformTime::Seconds() after which we give up, 0 to wait forever
+	double Deadline = 0.0;
+};
+
+/** The last copy of a JSON state SyncJsonState sent, the next call only sends what changed since */
+struct FBluSyncedJsonState
+{
+	TSharedPtr<FJsonObject> Sent;
+
+	// Send it whole on the next tick, the page lost it
+	bool bResend = false;
+};
+
+/** A page event held back while its JSON is parsed on a worker, or behind one that is */
+struct FBluQueuedScriptEvent
+{
+	FString Name;
+	FBluEventPayload Payload;
+
+	// Not valid if the payload isn't being parsed
+	TFuture<TSharedPtr<FJsonValue>> ParsedValue;
+};
+
+UENUM(BlueprintType)
+enum class EBluInputType : uint8
+{
+	MouseMove UMETA(DisplayName = "Mouse Move"),
+	MouseDown UMETA(DisplayName = "Mouse Down"),
+	MouseUp UMETA(DisplayName = "Mouse Up"),
+	MouseClick UMETA(DisplayName = "Mouse Click"),
+	MouseWheel UMETA(DisplayName = "Mouse Wheel"),
+	KeyDown UMETA(DisplayName = "Key Down"),
+	KeyUp UMETA(DisplayName = "Key Up"),
+	KeyPress UMETA(DisplayName = "Key Press"),
+	Char UMETA(DisplayName = "Character")
+};
+
+UENUM(BlueprintType)
+enum class EBluMouseButton : uint8
+{
+	Left,
+	Middle,
+	Right
+};
+
+/** One piece of input for UBluEye::SubmitInput, only the fields its type uses are read */
+USTRUCT(BlueprintType)
+struct FBluInputEvent
+{
+	GENERATED_USTRUCT_BODY()
+
+	UPROPERTY(EditAnywhere, BlueprintReadWrite, Category = "Blu")
+	EBluInputType Type = EBluInputType::MouseMove;
+
+	/** Events are delivered by sequence, ones with the same sequence in the order they were submitted */
+	UPROPERTY(EditAnywhere, BlueprintReadWrite, Category = "Blu")
+	int32 Sequence = 0;
+
+	/** Mouse position in the same space as Trigger* takes it, divided by Scale */
+	UPROPERTY(EditAnywhere, BlueprintReadWrite, Category = "Blu")
+	FVector2D Position = FVector2D::ZeroVector;
+
+	UPROPERTY(EditAnywhere, BlueprintReadWrite, Category = "Blu")
+	float Scale = 1.f;
+
+	UPROPERTY(EditAnywhere, BlueprintReadWrite, Category = "Blu")
+	EBluMouseButton Button = EBluMouseButton::Left;
+
+	UPROPERTY(EditAnywhere, BlueprintReadWrite, Category = "Blu")
+	float WheelDelta = 0.f;
+
+	/** Key code for key events, as FKeyEvent::GetKeyCode gives it */
+	UPROPERTY(EditAnywhere, BlueprintReadWrite, Category = "Blu")
+	int32 KeyCode = 0;
+
+	/** Character for char events, only the first one is sent */
+	UPROPERTY(EditAnywhere, BlueprintReadWrite, Category = "Blu")
+	FString Character;
+
+	UPROPERTY(EditAnywhere, BlueprintReadWrite, Category = "Blu")
+	bool bShiftDown = false;
+
+	UPROPERTY(EditAnywhere, BlueprintReadWrite, Category = "Blu")
+	bool bControlDown = false;
+
+	UPROPERTY(EditAnywhere, BlueprintReadWrite, Category = "Blu")
+	bool bAltDown = false;
+
+	UPROPERTY(EditAnywhere, BlueprintReadWrite, Category = "Blu")
+	bool bCommandDown = false;
+};
+
 USTRUCT(BlueprintType)
 struct FBluEyeSettings
 {
@@ -85,11 +259,63 @@ struct FBluEyeSettings
 	UPROPERTY(EditAnywhere, BlueprintReadWrite, Category = "Blu")
 	bool bDebugLogTick;
 
+	/**
+	 * Share one browser and texture with other eyes using the same URL, size and settings.
+	 * LoadURL and ActivatePreloaded move the browser to the new URL, navigation started by the page itself isn't followed
+	 */
+	UPROPERTY(EditAnywhere, BlueprintReadWrite, Category = "Blu")
+	bool bShareBrowser;
+
+	/** Should input on a shared eye be forwarded to the shared browser? If false, input is ignored */
+	UPROPERTY(EditAnywhere, BlueprintReadWrite, Category = "Blu")
+	bool bSharedInputEnabled;
+
+	/**
+	 * Queue ExecuteJS calls and send them as one script right before the CEF message loop runs.
+	 * Each call runs in its own try block, so one that throws doesn't stop the rest, and top level let/const don't carry over.
+	 * A syntax error in any call drops that frame's whole batch. For snippets you don't control, call FlushJS right before
+	 * and after ExecuteJS so they go out as their own script, or turn batching off
+	 */
+	UPROPERTY(EditAnywhere, BlueprintReadWrite, Category = "Blu")
+	bool bBatchJavaScript;
+
+	/** Keep a standby browser that reloads the page if the render process crashes */
+	UPROPERTY(EditAnywhere, BlueprintReadWrite, Category = "Blu")
+	bool bEnableCrashRecovery;
+
+	/** Have the page buffer blu_event calls and send them once per animation frame */
+	UPROPERTY(EditAnywhere, BlueprintReadWrite, Category = "Blu")
+	bool bBatchScriptEvents;
+
+	/** When batching, only the last value of these events is sent each frame */
+	UPROPERTY(EditAnywhere, BlueprintReadWrite, Category = "Blu")
+	TArray<FString> CoalescedScriptEvents;
+
+	/**
+	 * Parse event data that's a large JSON object or array on a worker thread, so listeners get it as a list or dictionary
+	 * without the game thread paying for the parse. Events are still delivered in the order they were sent, a tick or more later
+	 */
+	UPROPERTY(EditAnywhere, BlueprintReadWrite, Category = "Blu")
+	bool bParseScriptEventsAsync;
+
 	FBluEyeSettings();
 };
 
 DECLARE_DYNAMIC_MULTICAST_DELEGATE_TwoParams(FScriptEvent, const FString&, EventName, const FString&, EventMessage);
+DECLARE_MULTICAST_DELEGATE_TwoParams(FBluTypedScriptEvent, const FString& /*EventName*/, const FBluEventPayload& /*Payload*/);
+DECLARE_DYNAMIC_DELEGATE_OneParam(FBluNamedScriptEvent, const FString&, EventMessage);
+DECLARE_MULTICAST_DELEGATE_OneParam(FBluNamedTypedScriptEvent, const FBluEventPayload& /*Payload*/);
 DECLARE_DYNAMIC_MULTICAST_DELEGATE_OneParam(FLogEvent, const FString&, LogText);
 DECLARE_DYNAMIC_MULTICAST_DELEGATE_OneParam(FDownloadCompleteSignature, FString, url);
 DECLARE_DYNAMIC_MULTICAST_DELEGATE_TwoParams(FDownloadUpdatedSignature, FString, url, float, percentage);
+DECLARE_MULTICAST_DELEGATE_OneParam(FBluLogEventNative, const FString& /*LogText*/);
+DECLARE_MULTICAST_DELEGATE_OneParam(FBluDownloadCompleteNative, const FString& /*Url*/);
+DECLARE_MULTICAST_DELEGATE_TwoParams(FBluDownloadUpdatedNative, const FString& /*Url*/, float /*Percentage*/);
+DECLARE_DYNAMIC_MULTICAST_DELEGATE_OneParam(FPreloadCompleteSignature, FString, url);
+DECLARE_DYNAMIC_MULTICAST_DELEGATE_OneParam(FRenderProcessRecoveredSignature, float, RecoverySeconds);
+DECLARE_DYNAMIC_MULTICAST_DELEGATE_TwoParams(FBluBulkDataSignature, FName, Channel, const TArray<uint8>&, Data);
+DECLARE_MULTICAST_DELEGATE_TwoParams(FBluBulkDataNative, FName /*Channel*/, const TArray<uint8>& /*Data*/);
+DECLARE_DYNAMIC_DELEGATE_TwoParams(FBluQueryHandler, int32, QueryId, const FString&, Payload);
+DECLARE_DYNAMIC_MULTICAST_DELEGATE_OneParam(FBluQueryCancelledSignature, int32, QueryId);
+DECLARE_MULTICAST_DELEGATE_OneParam(FBluQueryCancelledNative, int32 /*QueryId*/);
 //DECLARE_DYNAMIC_MULTICAST_DELEGATE(FDownloadComplete);
\ No newline at end of file
@@ -4,7 +4,11 @@
 #include "BluTypes.h"
 
 class UBluEye;
+class FJsonValue;
 
+// Convert between CEF values and JSON without going through a string
+TSharedPtr<FJsonValue> CefValueToJson(CefRefPtr<CefValue> Value);
+CefRefPtr<CefValue> JsonToCefValue(const TSharedPtr<FJsonValue>& Value);
 
 class RenderHandler : public CefRenderHandler
 {
@@ -14,6 +18,9 @@ class RenderHandler : public CefRenderHandler
 		int32 Width;
 		int32 Height;
 
+		// If false, paints are dropped instead of uploaded to the parent's texture
+		bool bPaintingEnabled;
+
 		// CefRenderHandler interface
 		virtual void GetViewRect(CefRefPtr<CefBrowser> Browser, CefRect &Rect) override;
 
@@ -28,12 +35,10 @@ class RenderHandler : public CefRenderHandler
 };
 
 // for manual render handler
-class BrowserClient : public CefClient, public CefLifeSpanHandler, public CefDownloadHandler, public CefDisplayHandler
+class BrowserClient : public CefClient, public CefLifeSpanHandler, public CefDownloadHandler, public CefDisplayHandler, public CefLoadHandler, public CefRequestHandler
 {
 
 	private:
-		FScriptEvent* EventEmitter;
-		FLogEvent* LogEmitter;
 		CefRefPtr<RenderHandler> RenderHandlerRef;
 
 		// For lifespan
@@ -42,7 +47,7 @@ class BrowserClient : public CefClient, public CefLifeSpanHandler, public CefDow
 		bool bIsClosing;
 
 	public:
-		BrowserClient(RenderHandler* InRenderHandler) : RenderHandlerRef(InRenderHandler)
+		BrowserClient(RenderHandler* InRenderHandler) : RenderHandlerRef(InRenderHandler), BrowserId(0), bIsClosing(false)
 		{
 		
 		};
@@ -69,6 +74,18 @@ class BrowserClient : public CefClient, public CefLifeSpanHandler, public CefDow
 			return this; 	
 		}
 
+		// Getter for load state
+		virtual CefRefPtr<CefLoadHandler> GetLoadHandler() override
+		{
+			return this;
+		}
+
+		// Getter for render process state
+		virtual CefRefPtr<CefRequestHandler> GetRequestHandler() override
+		{
+			return this;
+		}
+
 		virtual bool OnProcessMessageReceived(CefRefPtr<CefBrowser> Browser, 
 			CefRefPtr<CefFrame> Frame,
 			CefProcessId SourceProcess, 
@@ -80,8 +97,6 @@ class BrowserClient : public CefClient, public CefLifeSpanHandler, public CefDow
 			CefRefPtr<CefV8Exception> Exception,
 			CefRefPtr<CefV8StackTrace> StackTrace);
 
-		void SetEventEmitter(FScriptEvent* Emitter);
-		void SetLogEmitter(FLogEvent* Emitter);
 
 		//CefDownloadHandler
 		virtual void OnBeforeDownload(
@@ -115,6 +130,20 @@ class BrowserClient : public CefClient, public CefLifeSpanHandler, public CefDow
 		void OnAfterCreated(CefRefPtr<CefBrowser> Browser) override;
 		void OnBeforeClose(CefRefPtr<CefBrowser> Browser) override;
 
+		//CefLoadHandler
+		virtual void OnLoadStart(CefRefPtr<CefBrowser> Browser,
+			CefRefPtr<CefFrame> Frame,
+			TransitionType Transition) override;
+
+		virtual void OnLoadingStateChange(CefRefPtr<CefBrowser> Browser,
+			bool bIsLoading,
+			bool bCanGoBack,
+			bool bCanGoForward) override;
+
+		//CefRequestHandler
+		virtual void OnRenderProcessTerminated(CefRefPtr<CefBrowser> Browser,
+			TerminationStatus Status) override;
+
 		virtual bool OnConsoleMessage(CefRefPtr<CefBrowser> Browser,
 				cef_log_severity_t Level,
 				const CefString& Message,